@@ -0,0 +1,405 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <new>
+
+/*
+ * Every allocation gets a small header in front of it, remembering its size and tag.
+ * That way operator delete knows what it is freeing, even on a different thread than the one that allocated.
+ *
+ * Counters are kept per thread, so threads never fight over the same cache lines and no atomic read-modify-write is needed.
+ * The peak is tracked per thread too and the report adds them up. That's exact when a tag's memory is allocated and
+ * freed on the same thread, and an upper bound when memory is freed on a different thread than the one that allocated it.
+ *
+ * Nothing in here may use 'new', it would call right back into ourselves.
+ */
+
+namespace
+{
+    constexpr std::uint32_t UntrackedTag = 0;
+    constexpr std::uint32_t UntaggedTag = 1;
+    constexpr std::uint32_t OverflowTag = AllocationTracker::MaxTags - 1;
+
+#if defined(ALLOCATION_TRACKER)
+    struct Header
+    {
+        std::uint64_t size;
+        std::uint32_t tag;
+        // Distance from the start of the malloc'd block to the user pointer
+        std::uint32_t offset;
+    };
+
+    static_assert(sizeof(Header) == 16, "The header must keep the user pointer 16 byte aligned");
+#endif
+
+    // Only the owning thread writes these, other threads only read them for the report
+    struct TagCounters
+    {
+        std::atomic<std::uint64_t> allocations;
+        std::atomic<std::uint64_t> bytes;
+        std::atomic<std::uint64_t> frees;
+
+        // Bytes allocated minus bytes freed by this thread, and the highest that ever got
+        std::atomic<std::int64_t> live;
+        std::atomic<std::int64_t> peak;
+    };
+
+    struct ThreadCounters
+    {
+        // All counters of one tag sit next to each other, so an allocation only touches one cache line
+        TagCounters tags[AllocationTracker::MaxTags];
+        ThreadCounters* next;
+    };
+
+    std::atomic<bool> enabled{ false };
+
+    std::mutex tagMutex;
+    const char* tagNames[AllocationTracker::MaxTags] = { "(untracked)", "(untagged)" };
+    std::atomic<std::uint32_t> tagCount{ 2 };
+
+    std::atomic<ThreadCounters*> allThreadCounters{ nullptr };
+
+    // Reset() remembers the totals at that point, the report shows everything after it
+    std::uint64_t baseAllocations[AllocationTracker::MaxTags];
+    std::uint64_t baseBytes[AllocationTracker::MaxTags];
+    std::uint64_t baseFrees[AllocationTracker::MaxTags];
+
+    thread_local std::uint32_t currentTag = UntaggedTag;
+
+#if defined(ALLOCATION_TRACKER)
+    thread_local ThreadCounters* threadCounters = nullptr;
+
+    ThreadCounters& GetThreadCounters()
+    {
+        if (threadCounters == nullptr)
+        {
+            // Placement new only constructs the object in memory we provide, it doesn't allocate
+            auto memory = std::malloc(sizeof(ThreadCounters));
+            threadCounters = new (memory) ThreadCounters();
+
+            // The counters are never freed, so the numbers of threads that already finished still show up in the report
+            auto head = allThreadCounters.load(std::memory_order_relaxed);
+            do
+            {
+                threadCounters->next = head;
+            } while (!allThreadCounters.compare_exchange_weak(head, threadCounters, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        return *threadCounters;
+    }
+
+    // Only the owning thread writes, so a plain load + store is enough and much cheaper than fetch_add
+    template <typename T>
+    T Bump(std::atomic<T>& counter, T amount)
+    {
+        const auto value = counter.load(std::memory_order_relaxed) + amount;
+        counter.store(value, std::memory_order_relaxed);
+        return value;
+    }
+
+    void* Allocate(std::size_t size, std::size_t alignment)
+    {
+        const auto slack = alignment > alignof(std::max_align_t) ? alignment : 0;
+
+        // Adding the header to a huge size would wrap around to a tiny block, fail instead like malloc itself would
+        if (size > SIZE_MAX - sizeof(Header) - slack)
+        {
+            return nullptr;
+        }
+
+        auto raw = std::malloc(size + sizeof(Header) + slack);
+        if (raw == nullptr)
+        {
+            return nullptr;
+        }
+
+        auto address = reinterpret_cast<std::uintptr_t>(raw) + sizeof(Header);
+        if (slack != 0)
+        {
+            address = (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+        }
+
+        auto header = reinterpret_cast<Header*>(address) - 1;
+        header->size = size;
+        header->offset = static_cast<std::uint32_t>(address - reinterpret_cast<std::uintptr_t>(raw));
+        header->tag = UntrackedTag;
+
+        if (enabled.load(std::memory_order_relaxed))
+        {
+            const auto tag = currentTag;
+            header->tag = tag;
+
+            auto& counters = GetThreadCounters();
+            Bump<std::uint64_t>(counters.tags[tag].allocations, 1);
+            Bump<std::uint64_t>(counters.tags[tag].bytes, size);
+
+            const auto live = Bump<std::int64_t>(counters.tags[tag].live, static_cast<std::int64_t>(size));
+            if (live > counters.tags[tag].peak.load(std::memory_order_relaxed))
+            {
+                counters.tags[tag].peak.store(live, std::memory_order_relaxed);
+            }
+        }
+
+        return reinterpret_cast<void*>(address);
+    }
+
+    void* AllocateOrThrow(std::size_t size, std::size_t alignment)
+    {
+        auto memory = Allocate(size, alignment);
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    void Free(void* memory)
+    {
+        if (memory == nullptr)
+        {
+            return;
+        }
+
+        auto header = static_cast<Header*>(memory) - 1;
+
+        // Allocations made while tracking was off are never counted, so their frees aren't either
+        if (header->tag != UntrackedTag)
+        {
+            auto& counters = GetThreadCounters();
+            Bump<std::uint64_t>(counters.tags[header->tag].frees, 1);
+            Bump<std::int64_t>(counters.tags[header->tag].live, -static_cast<std::int64_t>(header->size));
+        }
+
+        std::free(static_cast<char*>(memory) - header->offset);
+    }
+
+#endif
+
+    struct TagTotals
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t frees = 0;
+        std::int64_t live = 0;
+        std::int64_t peak = 0;
+    };
+
+    TagTotals SumTag(std::uint32_t tag)
+    {
+        TagTotals totals;
+        for (auto counters = allThreadCounters.load(std::memory_order_acquire); counters != nullptr; counters = counters->next)
+        {
+            totals.allocations += counters->tags[tag].allocations.load(std::memory_order_relaxed);
+            totals.bytes += counters->tags[tag].bytes.load(std::memory_order_relaxed);
+            totals.frees += counters->tags[tag].frees.load(std::memory_order_relaxed);
+            totals.live += counters->tags[tag].live.load(std::memory_order_relaxed);
+            totals.peak += counters->tags[tag].peak.load(std::memory_order_relaxed);
+        }
+        return totals;
+    }
+
+    template <typename WriteRow>
+    void ForEachTag(WriteRow writeRow)
+    {
+        // Collect everything first, so the allocations done while printing don't show up in the numbers
+        TagTotals totals[AllocationTracker::MaxTags];
+
+        const auto count = tagCount.load(std::memory_order_acquire);
+        for (std::uint32_t tag = UntaggedTag; tag < count; tag++)
+        {
+            totals[tag] = SumTag(tag);
+        }
+
+        for (std::uint32_t tag = UntaggedTag; tag < count; tag++)
+        {
+            writeRow(tagNames[tag], totals[tag].allocations - baseAllocations[tag], totals[tag].bytes - baseBytes[tag],
+                totals[tag].frees - baseFrees[tag], totals[tag].live, totals[tag].peak);
+        }
+    }
+}
+
+/*
+ * AllocationTracker
+ */
+
+bool AllocationTracker::IsAvailable()
+{
+#if defined(ALLOCATION_TRACKER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationTracker::Enable()
+{
+    // Without the replaced operators there's nothing to count, and the report stays empty
+    enabled.store(IsAvailable(), std::memory_order_relaxed);
+}
+
+void AllocationTracker::Disable()
+{
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::IsEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+std::uint32_t AllocationTracker::GetTag(const char* name)
+{
+    const auto seen = tagCount.load(std::memory_order_acquire);
+    for (std::uint32_t tag = UntaggedTag; tag < seen; tag++)
+    {
+        if (std::strcmp(tagNames[tag], name) == 0)
+        {
+            return tag;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(tagMutex);
+
+    // Other threads might have registered more tags while we were waiting for the lock
+    const auto count = tagCount.load(std::memory_order_relaxed);
+    for (auto tag = seen; tag < count; tag++)
+    {
+        if (std::strcmp(tagNames[tag], name) == 0)
+        {
+            return tag;
+        }
+    }
+
+    if (count >= OverflowTag)
+    {
+        tagNames[OverflowTag] = "(overflow)";
+        tagCount.store(MaxTags, std::memory_order_release);
+        return OverflowTag;
+    }
+
+    tagNames[count] = name;
+    tagCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void AllocationTracker::PrintReport(std::ostream& out)
+{
+    out << std::left << std::setw(24) << "Tag" << std::right
+        << std::setw(14) << "Allocations" << std::setw(16) << "Bytes" << std::setw(14) << "Frees"
+        << std::setw(16) << "Live bytes" << std::setw(16) << "Peak bytes" << std::endl;
+
+    ForEachTag([&](const char* name, std::uint64_t allocations, std::uint64_t bytes, std::uint64_t frees, std::int64_t live, std::int64_t peak)
+    {
+        out << std::left << std::setw(24) << name << std::right
+            << std::setw(14) << allocations << std::setw(16) << bytes << std::setw(14) << frees
+            << std::setw(16) << live << std::setw(16) << peak << std::endl;
+    });
+}
+
+void AllocationTracker::WriteReportCsv(std::ostream& out)
+{
+    out << "tag,allocations,bytes,frees,live_bytes,peak_bytes\n";
+
+    ForEachTag([&](const char* name, std::uint64_t allocations, std::uint64_t bytes, std::uint64_t frees, std::int64_t live, std::int64_t peak)
+    {
+        out << name << ',' << allocations << ',' << bytes << ',' << frees << ',' << live << ',' << peak << '\n';
+    });
+}
+
+void AllocationTracker::Reset()
+{
+    const auto count = tagCount.load(std::memory_order_acquire);
+    for (std::uint32_t tag = UntaggedTag; tag < count; tag++)
+    {
+        const auto totals = SumTag(tag);
+        baseAllocations[tag] = totals.allocations;
+        baseBytes[tag] = totals.bytes;
+        baseFrees[tag] = totals.frees;
+
+        for (auto counters = allThreadCounters.load(std::memory_order_acquire); counters != nullptr; counters = counters->next)
+        {
+            counters->tags[tag].peak.store(counters->tags[tag].live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+}
+
+/*
+ * AllocationScope
+ */
+
+AllocationScope::AllocationScope(const char* tagName) : previousTag(currentTag)
+{
+    currentTag = AllocationTracker::GetTag(tagName);
+}
+
+AllocationScope::~AllocationScope()
+{
+    currentTag = previousTag;
+}
+
+/*
+ * The replaced global operators
+ *
+ * All of these have to be replaced together, since operator delete expects the header that our operator new wrote.
+ * Only with ALLOCATION_TRACKER defined, otherwise every allocation would pay for the header even with tracking off.
+ */
+
+#if defined(ALLOCATION_TRACKER)
+
+void* operator new(std::size_t size)
+{
+    return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size)
+{
+    return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept { Free(memory); }
+void operator delete[](void* memory) noexcept { Free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { Free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { Free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { Free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { Free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { Free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { Free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { Free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { Free(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { Free(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { Free(memory); }
+
+#endif
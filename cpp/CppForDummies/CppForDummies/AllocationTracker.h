@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+ * Allocation tracker
+ *
+ * Every 'new' in the program (including the ones std::string, std::vector etc. do behind the scenes) goes through
+ * the global operator new. AllocationTracker.cpp replaces it, so we can count how many allocations happen,
+ * how many bytes they ask for and how much memory is alive at the same time.
+ *
+ * Replacing operator new costs something on every allocation, even while nobody is counting: a header in front of
+ * every block, and looking it up again on delete. So it's only done when ALLOCATION_TRACKER is defined (the Debug
+ * configurations do), other builds use the normal allocator and the tracker reports nothing.
+ *
+ * Tracking is off until Enable() is called. While it's off, the replaced operator new only does a little extra work.
+ *
+ * Allocations are attributed to a 'tag', which is whatever AllocationScope is active on the thread:
+ *
+ *      {
+ *          AllocationScope scope("Variables");
+ *          Variables();    // Everything allocated in here is counted towards "Variables"
+ *      }
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+class AllocationTracker
+{
+public:
+	// Maximum number of different tags, extra tags are counted as "(overflow)"
+	static constexpr int MaxTags = 64;
+
+	// False when built without ALLOCATION_TRACKER, Enable() then does nothing
+	static bool IsAvailable();
+
+	static void Enable();
+	static void Disable();
+	static bool IsEnabled();
+
+	// Returns the id for the tag name, registering it the first time. The name must outlive the program (a string literal).
+	static std::uint32_t GetTag(const char* name);
+
+	// Prints a table with allocation count, bytes, frees, live bytes and peak live bytes for every tag
+	static void PrintReport(std::ostream& out);
+
+	// Same numbers as PrintReport, as comma separated values
+	static void WriteReportCsv(std::ostream& out);
+
+	// Sets every counter back to zero (live bytes are kept, those allocations still exist)
+	static void Reset();
+};
+
+class AllocationScope
+{
+public:
+	explicit AllocationScope(const char* tagName);
+	~AllocationScope();
+
+	AllocationScope(const AllocationScope&) = delete;
+	AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+	std::uint32_t previousTag;
+};
@@ -0,0 +1,416 @@
+#pragma once
+
+/*
+ * ArrayAlgorithms - <algorithm> for std::array, taking advantage of knowing the size at compile time
+ *
+ * std::accumulate and friends work on any range, so they walk it one element at a time. For a std::array<T, N>
+ * the compiler knows N, and these versions are written so that it can turn them into straight-line SIMD code:
+ *
+ *      ArrayReduce                 combines several 'lanes' side by side, then combines the lanes
+ *      ArraySum                    floats in lanes like ArrayReduce. Integers are a plain loop, since the order never
+ *                                  matters for them and compilers already turn that into the best SIMD code.
+ *      ArrayMin, ArrayMax,         the same, keeping the smallest or biggest of every lane
+ *      ArrayMinMax
+ *      ArrayFind                   compares a whole block of elements before checking whether any of them matched,
+ *                                  with SSE2 for ints and floats
+ *      ArraySort                   a sorting network: a fixed list of compare-and-swap steps, so there are no branches
+ *                                  to mispredict. Small networks are spelled out step by step, bigger ones are a loop
+ *                                  over the list of steps (spelling out thousands of steps takes ages to compile).
+ *      ArrayTransform              builds the new array in one go
+ *
+ * Everything is constexpr, so it also works at compile time:
+ *
+ *      constexpr std::array<int, 4> values = { 3, 1, 4, 1 };
+ *      static_assert(ArraySum(values) == 9);
+ *      static_assert(ArraySort(values) == std::array<int, 4>{ 1, 1, 3, 4 });
+ *
+ * Combining in lanes changes the order of the additions, so a float ArraySum can differ from std::accumulate
+ * in the last bits (usually it's more accurate, not less). ArrayReduce expects an operation where the order
+ * doesn't matter, like + or min.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARRAY_ALGORITHMS_SSE2 1
+#else
+#define ARRAY_ALGORITHMS_SSE2 0
+#endif
+
+// Sorting networks up to this size are turned into straight-line code, bigger ones are run in a loop
+constexpr std::size_t UnrolledSortNetworkMaxSize = 64;
+
+namespace Detail
+{
+	// Two AVX registers worth of elements, so two independent additions can be in flight at once
+	template <typename T, std::size_t N>
+	constexpr std::size_t LaneCount = std::bit_floor(std::min<std::size_t>(N, 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1));
+
+	template <typename T>
+	constexpr const T& Smaller(const T& a, const T& b) { return b < a ? b : a; }
+
+	template <typename T>
+	constexpr const T& Bigger(const T& a, const T& b) { return a < b ? b : a; }
+
+	// Combines the first half of the lanes with the second half, then the first quarter with the second quarter...
+	template <std::size_t Width, typename T, std::size_t Lanes, typename Operation, std::size_t... Lane>
+	constexpr void FoldLanes(std::array<T, Lanes>& lanes, Operation& operation, std::index_sequence<Lane...>)
+	{
+		((lanes[Lane] = operation(lanes[Lane], lanes[Lane + Width])), ...);
+		if constexpr (Width > 1)
+		{
+			FoldLanes<Width / 2>(lanes, operation, std::make_index_sequence<Width / 2>());
+		}
+	}
+
+	// Combines N > 0 elements in lanes: lane i gets elements i, i + Lanes, i + 2 * Lanes...
+	template <typename T, std::size_t N, typename Operation, std::size_t... Lane>
+	constexpr T ReduceLanes(const std::array<T, N>& values, Operation& operation, std::index_sequence<Lane...>)
+	{
+		constexpr auto Lanes = sizeof...(Lane);
+		constexpr auto Blocks = N / Lanes;
+		std::array<T, Lanes> lanes = { values[Lane]... };
+
+		for (std::size_t block = 1; block < Blocks; block++)
+		{
+			((lanes[Lane] = operation(lanes[Lane], values[block * Lanes + Lane])), ...);
+		}
+		for (auto i = Blocks * Lanes; i < N; i++)
+		{
+			lanes[i - Blocks * Lanes] = operation(lanes[i - Blocks * Lanes], values[i]);
+		}
+
+		if constexpr (Lanes > 1)
+		{
+			FoldLanes<Lanes / 2>(lanes, operation, std::make_index_sequence<Lanes / 2>());
+		}
+		return lanes[0];
+	}
+
+	// Goes backwards without stopping, so the first match is left over at the end. No branches, for small arrays.
+	template <typename T, std::size_t N, std::size_t... Index>
+	constexpr std::size_t FindWithoutBranches(const std::array<T, N>& values, const T& value, std::index_sequence<Index...>)
+	{
+		std::size_t found = N;
+		((found = values[N - 1 - Index] == value ? N - 1 - Index : found), ...);
+		return found;
+	}
+
+	// Compares the whole block without stopping at the first match (| instead of ||), which becomes a few SIMD instructions
+	template <typename T, std::size_t N, std::size_t... Lane>
+	constexpr bool BlockContains(const std::array<T, N>& values, std::size_t start, const T& value, std::index_sequence<Lane...>)
+	{
+		return ((values[start + Lane] == value) | ...);
+	}
+
+#if ARRAY_ALGORITHMS_SSE2
+	// Compilers don't turn a search with an early exit into SIMD code by themselves, so here it is by hand for 4 byte values
+	template <typename T>
+	std::size_t FindSse2(const T* values, std::size_t count, T value)
+	{
+		std::size_t i = 0;
+		if constexpr (std::is_same_v<T, float>)
+		{
+			const auto wanted = _mm_set1_ps(value);
+			for (; i + 4 <= count; i += 4)
+			{
+				const auto mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(values + i), wanted));
+				if (mask != 0)
+				{
+					return i + std::countr_zero(static_cast<unsigned>(mask));
+				}
+			}
+		}
+		else
+		{
+			const auto wanted = _mm_set1_epi32(static_cast<int>(value));
+			for (; i + 4 <= count; i += 4)
+			{
+				const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+				const auto mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, wanted)));
+				if (mask != 0)
+				{
+					return i + std::countr_zero(static_cast<unsigned>(mask));
+				}
+			}
+		}
+
+		for (; i < count; i++)
+		{
+			if (values[i] == value)
+			{
+				return i;
+			}
+		}
+		return count;
+	}
+#endif
+
+	// Compare-and-swap steps of Batcher's odd-even merge sort, for any N
+	struct SortStep
+	{
+		std::uint16_t first;
+		std::uint16_t second;
+	};
+
+	template <typename Visitor>
+	constexpr void VisitSortNetwork(std::size_t n, Visitor visitor)
+	{
+		for (std::size_t p = 1; p < n; p += p)
+		{
+			for (auto k = p; k >= 1; k /= 2)
+			{
+				for (auto j = k % p; j + k < n; j += 2 * k)
+				{
+					for (std::size_t i = 0; i < k && i + j + k < n; i++)
+					{
+						if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+						{
+							visitor(i + j, i + j + k);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	template <std::size_t N>
+	constexpr std::size_t SortNetworkSize()
+	{
+		std::size_t steps = 0;
+		VisitSortNetwork(N, [&steps](std::size_t, std::size_t) { steps++; });
+		return steps;
+	}
+
+	template <std::size_t N>
+	constexpr auto MakeSortNetwork()
+	{
+		std::array<SortStep, SortNetworkSize<N>()> network = {};
+		std::size_t step = 0;
+		VisitSortNetwork(N, [&](std::size_t first, std::size_t second)
+		{
+			network[step++] = { static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(second) };
+		});
+		return network;
+	}
+
+	template <std::size_t N>
+	constexpr auto SortNetwork = MakeSortNetwork<N>();
+
+	template <typename T, std::size_t N>
+	constexpr void CompareAndSwap(std::array<T, N>& values, std::size_t first, std::size_t second)
+	{
+		if constexpr (std::is_arithmetic_v<T>)
+		{
+			// Two separate comparisons compile to min and max instructions, one shared comparison to a branch
+			const auto a = values[first];
+			const auto b = values[second];
+			values[first] = b < a ? b : a;
+			values[second] = a < b ? b : a;
+		}
+		else if (values[second] < values[first])
+		{
+			std::swap(values[first], values[second]);
+		}
+	}
+
+	// Every step spelled out, so the indices are constants in the generated code
+	template <typename T, std::size_t N, std::size_t... Step>
+	constexpr void RunUnrolledSortNetwork(std::array<T, N>& values, std::index_sequence<Step...>)
+	{
+		(CompareAndSwap(values, SortNetwork<N>[Step].first, SortNetwork<N>[Step].second), ...);
+	}
+
+	template <typename T, std::size_t N>
+	constexpr void RunSortNetwork(std::array<T, N>& values)
+	{
+		for (const auto& step : SortNetwork<N>)
+		{
+			CompareAndSwap(values, step.first, step.second);
+		}
+	}
+
+	template <typename T, std::size_t N, typename Function, std::size_t... Index>
+	constexpr auto TransformArray(const std::array<T, N>& values, Function& function, std::index_sequence<Index...>)
+	{
+		return std::array<std::invoke_result_t<Function&, const T&>, N>{ function(values[Index])... };
+	}
+}
+
+// Combines all elements with 'operation', starting from 'initial'. The order of the combinations isn't left to right.
+template <typename T, std::size_t N, typename Operation>
+constexpr T ArrayReduce(const std::array<T, N>& values, T initial, Operation operation)
+{
+	if constexpr (N == 0)
+	{
+		return initial;
+	}
+	else
+	{
+		return operation(initial, Detail::ReduceLanes(values, operation, std::make_index_sequence<Detail::LaneCount<T, N>>()));
+	}
+}
+
+template <typename T, std::size_t N>
+constexpr T ArraySum(const std::array<T, N>& values)
+{
+	if constexpr (std::is_integral_v<T>)
+	{
+		// The order never matters for integers, so compilers already turn a plain loop into the best SIMD code
+		T sum = 0;
+		for (const auto& value : values)
+		{
+			sum += value;
+		}
+		return sum;
+	}
+	else
+	{
+		return ArrayReduce(values, T{}, std::plus<>());
+	}
+}
+
+template <typename T, std::size_t N>
+constexpr T ArrayMin(const std::array<T, N>& values)
+{
+	static_assert(N > 0, "An empty array has no smallest element");
+	auto smaller = [](const T& a, const T& b) { return Detail::Smaller(a, b); };
+	return Detail::ReduceLanes(values, smaller, std::make_index_sequence<Detail::LaneCount<T, N>>());
+}
+
+template <typename T, std::size_t N>
+constexpr T ArrayMax(const std::array<T, N>& values)
+{
+	static_assert(N > 0, "An empty array has no biggest element");
+	auto bigger = [](const T& a, const T& b) { return Detail::Bigger(a, b); };
+	return Detail::ReduceLanes(values, bigger, std::make_index_sequence<Detail::LaneCount<T, N>>());
+}
+
+// Both in a single pass over the array
+template <typename T, std::size_t N>
+constexpr std::pair<T, T> ArrayMinMax(const std::array<T, N>& values)
+{
+	static_assert(N > 0, "An empty array has no smallest or biggest element");
+	constexpr auto Lanes = Detail::LaneCount<T, N>;
+	constexpr auto Blocks = N / Lanes;
+
+	auto smaller = [](const T& a, const T& b) { return Detail::Smaller(a, b); };
+	auto bigger = [](const T& a, const T& b) { return Detail::Bigger(a, b); };
+
+	std::array<T, Lanes> smallest = {};
+	std::array<T, Lanes> biggest = {};
+	for (std::size_t i = 0; i < Lanes; i++)
+	{
+		smallest[i] = values[i];
+		biggest[i] = values[i];
+	}
+
+	for (std::size_t block = 1; block < Blocks; block++)
+	{
+		for (std::size_t i = 0; i < Lanes; i++)
+		{
+			smallest[i] = smaller(smallest[i], values[block * Lanes + i]);
+			biggest[i] = bigger(biggest[i], values[block * Lanes + i]);
+		}
+	}
+	for (auto i = Blocks * Lanes; i < N; i++)
+	{
+		smallest[i - Blocks * Lanes] = smaller(smallest[i - Blocks * Lanes], values[i]);
+		biggest[i - Blocks * Lanes] = bigger(biggest[i - Blocks * Lanes], values[i]);
+	}
+
+	if constexpr (Lanes > 1)
+	{
+		Detail::FoldLanes<Lanes / 2>(smallest, smaller, std::make_index_sequence<Lanes / 2>());
+		Detail::FoldLanes<Lanes / 2>(biggest, bigger, std::make_index_sequence<Lanes / 2>());
+	}
+	return { smallest[0], biggest[0] };
+}
+
+// The index of the first element equal to 'value', or N if there is none
+template <typename T, std::size_t N>
+constexpr std::size_t ArrayFind(const std::array<T, N>& values, const T& value)
+{
+#if ARRAY_ALGORITHMS_SSE2
+	if constexpr (N >= 16 && sizeof(T) == 4 && (std::is_integral_v<T> || std::is_same_v<T, float>))
+	{
+		if (!std::is_constant_evaluated())
+		{
+			return Detail::FindSse2(values.data(), N, value);
+		}
+	}
+#endif
+
+	if constexpr (N < 16)
+	{
+		return Detail::FindWithoutBranches(values, value, std::make_index_sequence<N>());
+	}
+	else
+	{
+		constexpr auto Lanes = Detail::LaneCount<T, N>;
+		std::size_t start = 0;
+		for (; start + Lanes <= N; start += Lanes)
+		{
+			if (Detail::BlockContains(values, start, value, std::make_index_sequence<Lanes>()))
+			{
+				break;
+			}
+		}
+
+		for (auto i = start; i < N; i++)
+		{
+			if (values[i] == value)
+			{
+				return i;
+			}
+		}
+		return N;
+	}
+}
+
+template <typename T, std::size_t N>
+constexpr bool ArrayContains(const std::array<T, N>& values, const T& value)
+{
+	return ArrayFind(values, value) != N;
+}
+
+// Sorted from smallest to biggest, using operator<
+template <typename T, std::size_t N>
+constexpr void ArraySortInPlace(std::array<T, N>& values)
+{
+	if constexpr (N <= UnrolledSortNetworkMaxSize)
+	{
+		Detail::RunUnrolledSortNetwork(values, std::make_index_sequence<Detail::SortNetwork<N>.size()>());
+	}
+	else if constexpr (std::is_arithmetic_v<T>)
+	{
+		Detail::RunSortNetwork(values);
+	}
+	else
+	{
+		// Without min and max instructions every step is a branch, and std::sort does far fewer comparisons
+		std::sort(values.begin(), values.end());
+	}
+}
+
+template <typename T, std::size_t N>
+constexpr std::array<T, N> ArraySort(std::array<T, N> values)
+{
+	ArraySortInPlace(values);
+	return values;
+}
+
+// A new array with 'function' applied to every element
+template <typename T, std::size_t N, typename Function>
+constexpr auto ArrayTransform(const std::array<T, N>& values, Function function)
+{
+	return Detail::TransformArray(values, function, std::make_index_sequence<N>());
+}
@@ -0,0 +1,2271 @@
+#include "Benchmarks.h"
+#include "AllocationTracker.h"
+#include "ArrayAlgorithms.h"
+#include "BlendSpace.h"
+#include "ConcurrentDummyClass.h"
+#include "Coroutines.h"
+#include "DependencyIndex.h"
+#include "DummyArchive.h"
+#include "EventQueue.h"
+#include "FlatHashMap.h"
+#include "InputDispatcher.h"
+#include "InternedName.h"
+#include "MyDummyClass.h"
+#include "NumericKernels.h"
+#include "PackageFile.h"
+#include "PathfindingService.h"
+#include "SignificanceManager.h"
+#include "SmallString.h"
+#include "SnapshotReplication.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    int HardwareThreads()
+    {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    /*
+     * Coroutines
+     */
+
+    Task<void> YieldLoop(Executor& executor, int yields)
+    {
+        for (auto i = 0; i < yields; i++)
+        {
+            co_await ScheduleOn{ executor };
+        }
+    }
+
+    Task<void> CountTask(std::atomic<int>& counter)
+    {
+        counter.fetch_add(1, std::memory_order_relaxed);
+        co_return;
+    }
+
+    void CoroutineBenchmark()
+    {
+        std::cout << "== Coroutines ==" << std::endl;
+
+        // Context switch: two tasks taking turns on one thread, every co_await is one switch
+        {
+            const auto yields = 1000000;
+            SingleThreadExecutor executor;
+            Spawn(executor, YieldLoop(executor, yields));
+            Spawn(executor, YieldLoop(executor, yields));
+
+            Stopwatch stopwatch;
+            executor.Run();
+            std::cout << "Coroutine switch (single thread): " << stopwatch.ElapsedNanoseconds() / (2.0 * yields) << " ns" << std::endl;
+        }
+
+        // Context switch: two threads handing a token back and forth, every hand-over is one switch
+        {
+            const auto switches = 100000;
+            std::mutex mutex;
+            std::condition_variable changed;
+            auto turn = 0;
+
+            auto player = [&](int me)
+            {
+                for (auto i = 0; i < switches; i++)
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&] { return turn == me; });
+                    turn = 1 - me;
+                    changed.notify_one();
+                }
+            };
+
+            Stopwatch stopwatch;
+            std::thread first(player, 0);
+            std::thread second(player, 1);
+            first.join();
+            second.join();
+            std::cout << "Thread switch (condition variable): " << stopwatch.ElapsedNanoseconds() / (2.0 * switches) << " ns" << std::endl;
+        }
+
+        // Throughput: lots of tiny tasks
+        const auto taskCount = 200000;
+        {
+            std::atomic<int> counter{ 0 };
+            SingleThreadExecutor executor;
+
+            Stopwatch stopwatch;
+            for (auto i = 0; i < taskCount; i++)
+            {
+                Spawn(executor, CountTask(counter));
+            }
+            executor.Run();
+            std::cout << "SingleThreadExecutor: " << taskCount / stopwatch.ElapsedSeconds() << " tasks/s" << std::endl;
+        }
+
+        {
+            std::atomic<int> counter{ 0 };
+            ThreadPoolExecutor executor(HardwareThreads());
+
+            Stopwatch stopwatch;
+            for (auto i = 0; i < taskCount; i++)
+            {
+                Spawn(executor, CountTask(counter));
+            }
+            executor.Run();
+            std::cout << "ThreadPoolExecutor(" << HardwareThreads() << "): " << taskCount / stopwatch.ElapsedSeconds() << " tasks/s" << std::endl;
+        }
+
+        // Starting a thread is far more expensive, so fewer tasks are used here
+        {
+            const auto threadTaskCount = 20000;
+            std::atomic<int> counter{ 0 };
+
+            Stopwatch stopwatch;
+            for (auto i = 0; i < threadTaskCount; i += HardwareThreads())
+            {
+                std::vector<std::thread> threads;
+                for (auto j = 0; j < HardwareThreads(); j++)
+                {
+                    threads.emplace_back([&] { counter.fetch_add(1, std::memory_order_relaxed); });
+                }
+                for (auto& thread : threads)
+                {
+                    thread.join();
+                }
+            }
+            std::cout << "std::thread per task: " << counter.load() / stopwatch.ElapsedSeconds() << " tasks/s" << std::endl;
+        }
+    }
+
+    /*
+     * Allocation tracker
+     */
+
+    using AllocateFunction = void* (*)(std::size_t);
+    using FreeFunction = void (*)(void*);
+
+    // The same allocations and frees through any allocator, called through pointers so every variant gets the same calls
+    double AllocationWorkload(AllocateFunction allocate, FreeFunction deallocate, std::vector<void*>& blocks)
+    {
+        Stopwatch stopwatch;
+
+        for (auto round = 0; round < 20; round++)
+        {
+            // Sizes like the text of short strings that don't fit into std::string's internal buffer
+            for (std::size_t i = 0; i < blocks.size(); i++)
+            {
+                blocks[i] = allocate(30 + i % 20);
+            }
+            for (auto block : blocks)
+            {
+                deallocate(block);
+            }
+        }
+
+        return stopwatch.ElapsedSeconds();
+    }
+
+    double Median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    void AllocationTrackerBenchmark()
+    {
+        std::cout << "== Allocation tracker ==" << std::endl;
+        if (!AllocationTracker::IsAvailable())
+        {
+            std::cout << "Built without ALLOCATION_TRACKER, operator new is the normal one" << std::endl;
+        }
+
+        const auto wasEnabled = AllocationTracker::IsEnabled();
+        std::vector<void*> blocks(100000);
+
+        struct Variant
+        {
+            const char* name;
+            AllocateFunction allocate;
+            FreeFunction deallocate;
+            bool tracking;
+            std::vector<double> seconds;
+        };
+
+        // malloc and free directly are the baseline: what allocating costs without any replaced operator new
+        Variant variants[] = {
+            { "malloc/free", [](std::size_t size) { return std::malloc(size); }, [](void* block) { std::free(block); }, false, {} },
+            { "operator new, tracking disabled", [](std::size_t size) { return ::operator new(size); }, [](void* block) { ::operator delete(block); }, false, {} },
+            { "operator new, tracking enabled", [](std::size_t size) { return ::operator new(size); }, [](void* block) { ::operator delete(block); }, true, {} },
+        };
+
+        // Without the tracker, enabling it changes nothing and the third variant would just repeat the second
+        const auto variantCount = AllocationTracker::IsAvailable() ? static_cast<int>(std::size(variants)) : 2;
+
+        // Many samples, each one starting with a different variant, so neither noise nor going first favours any of them
+        const auto samples = 21;
+        for (auto sample = 0; sample < samples; sample++)
+        {
+            for (auto i = 0; i < variantCount; i++)
+            {
+                auto& variant = variants[(sample + i) % variantCount];
+                if (variant.tracking)
+                {
+                    AllocationTracker::Enable();
+                }
+                else
+                {
+                    AllocationTracker::Disable();
+                }
+
+                AllocationScope scope("Benchmark");
+                variant.seconds.push_back(AllocationWorkload(variant.allocate, variant.deallocate, blocks));
+            }
+        }
+
+        if (wasEnabled)
+        {
+            AllocationTracker::Enable();
+        }
+        else
+        {
+            AllocationTracker::Disable();
+        }
+
+        const auto baseline = Median(variants[0].seconds);
+        for (auto i = 0; i < variantCount; i++)
+        {
+            const auto& variant = variants[i];
+            const auto median = Median(variant.seconds);
+            std::cout << variant.name << ": median " << median * 1000.0 << " ms (" << *std::min_element(variant.seconds.begin(), variant.seconds.end()) * 1000.0
+                << " to " << *std::max_element(variant.seconds.begin(), variant.seconds.end()) * 1000.0 << " ms over " << samples << " samples), "
+                << (median / baseline - 1.0) * 100.0 << " % over malloc/free" << std::endl;
+        }
+        if (AllocationTracker::IsAvailable())
+        {
+            AllocationTracker::PrintReport(std::cout);
+        }
+    }
+
+    /*
+     * Strings
+     */
+
+    // The compiler can't throw away work whose result ends up in here
+    volatile std::size_t sink;
+
+    std::vector<std::string> MakeBindingNames(int count)
+    {
+        const char* bases[] = { "MoveForward", "MoveRight", "Turn", "TurnRate", "LookUp", "LookUpRate", "Jump",
+            "/Game/Mannequin/Character/Mesh/SK_Mannequin_PhysicsAsset", "/Game/ThirdPersonCPP/Blueprints/ThirdPersonCharacter" };
+
+        std::vector<std::string> names;
+        for (auto i = 0; i < count; i++)
+        {
+            names.push_back(std::string(bases[i % 9]) + "_" + std::to_string(i));
+        }
+        return names;
+    }
+
+    template <typename Function>
+    void Measure(const char* label, int operations, Function function)
+    {
+        Stopwatch stopwatch;
+        function();
+        std::cout << label << ": " << stopwatch.ElapsedNanoseconds() / operations << " ns/op" << std::endl;
+    }
+
+    void StringBenchmark()
+    {
+        std::cout << "== Strings ==" << std::endl;
+
+        const auto nameCount = 1000;
+        const auto rounds = 1000;
+        const auto operations = nameCount * rounds;
+        const auto texts = MakeBindingNames(nameCount);
+
+        // Construction
+        Measure("Construct std::string", operations, [&]
+        {
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (const auto& text : texts)
+                {
+                    std::string copy(text);
+                    sink = sink + copy.size();
+                }
+            }
+        });
+
+        Measure("Construct SmallString", operations, [&]
+        {
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (const auto& text : texts)
+                {
+                    SmallString copy(text);
+                    sink = sink + copy.Len();
+                }
+            }
+        });
+
+        Measure("Construct InternedName (already interned)", operations, [&]
+        {
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (const auto& text : texts)
+                {
+                    InternedName name(text);
+                    sink = sink + name.GetId();
+                }
+            }
+        });
+
+        // Comparison - equal text in different objects, the worst case for string comparison since every character is looked at
+        std::vector<std::string> stringsA(texts.begin(), texts.end());
+        std::vector<std::string> stringsB(texts.begin(), texts.end());
+        std::vector<SmallString> smallA(texts.begin(), texts.end());
+        std::vector<SmallString> smallB(texts.begin(), texts.end());
+        std::vector<InternedName> namesA;
+        std::vector<InternedName> namesB;
+        for (const auto& text : texts)
+        {
+            namesA.emplace_back(text);
+            namesB.emplace_back(text);
+        }
+
+        Measure("Compare std::string", operations, [&]
+        {
+            std::size_t equal = 0;
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (auto i = 0; i < nameCount; i++)
+                {
+                    equal += stringsA[i] == stringsB[i];
+                }
+            }
+            sink = equal;
+        });
+
+        Measure("Compare SmallString", operations, [&]
+        {
+            std::size_t equal = 0;
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (auto i = 0; i < nameCount; i++)
+                {
+                    equal += smallA[i] == smallB[i];
+                }
+            }
+            sink = equal;
+        });
+
+        Measure("Compare InternedName", operations, [&]
+        {
+            std::size_t equal = 0;
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (auto i = 0; i < nameCount; i++)
+                {
+                    equal += namesA[i] == namesB[i];
+                }
+            }
+            sink = equal;
+        });
+
+        // Map lookups
+        std::unordered_map<std::string, int> stringMap;
+        std::unordered_map<SmallString, int> smallMap;
+        std::unordered_map<InternedName, int> nameMap;
+        for (auto i = 0; i < nameCount; i++)
+        {
+            stringMap[stringsA[i]] = i;
+            smallMap[smallA[i]] = i;
+            nameMap[namesA[i]] = i;
+        }
+
+        Measure("Map lookup std::string", operations, [&]
+        {
+            std::size_t total = 0;
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (const auto& key : stringsB)
+                {
+                    total += stringMap.find(key)->second;
+                }
+            }
+            sink = total;
+        });
+
+        Measure("Map lookup SmallString", operations, [&]
+        {
+            std::size_t total = 0;
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (const auto& key : smallB)
+                {
+                    total += smallMap.find(key)->second;
+                }
+            }
+            sink = total;
+        });
+
+        Measure("Map lookup InternedName", operations, [&]
+        {
+            std::size_t total = 0;
+            for (auto round = 0; round < rounds; round++)
+            {
+                for (const auto& key : namesB)
+                {
+                    total += nameMap.find(key)->second;
+                }
+            }
+            sink = total;
+        });
+    }
+
+    /*
+     * Hash maps
+     */
+
+    template <typename Map, typename Insert, typename Lookup, typename Erase>
+    void MapBenchmark(const char* label, const std::vector<std::uint64_t>& keys, const std::vector<std::uint64_t>& misses,
+        Insert insert, Lookup lookup, Erase erase)
+    {
+        const auto count = static_cast<double>(keys.size());
+        Map map;
+
+        Stopwatch stopwatch;
+        for (auto key : keys)
+        {
+            insert(map, key);
+        }
+        const auto insertNs = stopwatch.ElapsedNanoseconds() / count;
+
+        // Look the keys up in a different order than they were added, so the caches don't help
+        stopwatch.Restart();
+        std::uint64_t found = 0;
+        for (auto i = keys.size(); i-- > 0;)
+        {
+            found += lookup(map, keys[i]);
+        }
+        const auto hitNs = stopwatch.ElapsedNanoseconds() / count;
+
+        stopwatch.Restart();
+        for (auto key : misses)
+        {
+            found += lookup(map, key);
+        }
+        const auto missNs = stopwatch.ElapsedNanoseconds() / count;
+
+        stopwatch.Restart();
+        for (auto key : keys)
+        {
+            erase(map, key);
+        }
+        const auto eraseNs = stopwatch.ElapsedNanoseconds() / count;
+
+        sink = found;
+        std::cout << label << " " << keys.size() << " keys: insert " << insertNs << " ns, find hit " << hitNs
+            << " ns, find miss " << missNs << " ns, erase " << eraseNs << " ns" << std::endl;
+    }
+
+    void HashMapBenchmarkSizes(const std::vector<std::size_t>& sizes)
+    {
+        std::mt19937_64 random(42);
+
+        for (auto size : sizes)
+        {
+            std::vector<std::uint64_t> keys(size);
+            std::vector<std::uint64_t> misses(size);
+            for (auto& key : keys)
+            {
+                // Keys have the lowest bit cleared and misses have it set, so no miss is ever a key
+                key = random() & ~1ull;
+            }
+            for (auto& key : misses)
+            {
+                key = random() | 1ull;
+            }
+
+            MapBenchmark<FlatHashMap<std::uint64_t, std::uint64_t>>("FlatHashMap", keys, misses,
+                [](auto& map, std::uint64_t key) { map.Add(key, key); },
+                [](auto& map, std::uint64_t key) { auto value = map.Find(key); return value != nullptr ? *value : 0; },
+                [](auto& map, std::uint64_t key) { map.Remove(key); });
+
+            MapBenchmark<std::unordered_map<std::uint64_t, std::uint64_t>>("std::unordered_map", keys, misses,
+                [](auto& map, std::uint64_t key) { map.emplace(key, key); },
+                [](auto& map, std::uint64_t key) { auto found = map.find(key); return found != map.end() ? found->second : 0; },
+                [](auto& map, std::uint64_t key) { map.erase(key); });
+        }
+    }
+
+    void HashMapBenchmark()
+    {
+        std::cout << "== Hash maps ==" << std::endl;
+        HashMapBenchmarkSizes({ 1000, 10000, 100000, 1000000, 10000000 });
+    }
+
+    // Needs several GB of memory, so it only runs when asked for by name
+    void HashMapLargeBenchmark()
+    {
+        std::cout << "== Hash maps (100M keys) ==" << std::endl;
+        HashMapBenchmarkSizes({ 100000000 });
+    }
+
+    /*
+     * Input queue
+     */
+
+    // The simplest possible thread-safe queue, as a baseline
+    template <typename T>
+    class MutexQueue
+    {
+    public:
+        bool TryPush(const T& value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            values.push_back(value);
+            return true;
+        }
+
+        bool TryPop(T& value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (values.empty())
+            {
+                return false;
+            }
+            value = values.front();
+            values.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex mutex;
+        std::deque<T> values;
+    };
+
+    template <typename Queue>
+    void QueueThroughput(const char* label, int producers)
+    {
+        const auto itemsPerProducer = 2000000 / producers;
+        const auto total = static_cast<std::uint64_t>(itemsPerProducer) * producers;
+        auto queue = std::make_unique<Queue>();
+
+        Stopwatch stopwatch;
+        std::vector<std::thread> threads;
+        for (auto p = 0; p < producers; p++)
+        {
+            threads.emplace_back([&]
+            {
+                for (auto i = 0; i < itemsPerProducer; i++)
+                {
+                    while (!queue->TryPush(static_cast<std::uint64_t>(i)))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::uint64_t received = 0;
+        std::uint64_t value;
+        while (received < total)
+        {
+            if (queue->TryPop(value))
+            {
+                received++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::cout << label << " (" << producers << " producers): " << total / stopwatch.ElapsedSeconds() / 1e6 << " M events/s" << std::endl;
+    }
+
+    void InputQueueBenchmark()
+    {
+        std::cout << "== Input queue ==" << std::endl;
+
+        QueueThroughput<SpscQueue<std::uint64_t, 4096>>("SpscQueue", 1);
+        QueueThroughput<MpscQueue<std::uint64_t, 4096>>("MpscQueue", 1);
+        QueueThroughput<MpscQueue<std::uint64_t, 4096>>("MpscQueue", 4);
+        QueueThroughput<MutexQueue<std::uint64_t>>("std::mutex + std::deque", 1);
+        QueueThroughput<MutexQueue<std::uint64_t>>("std::mutex + std::deque", 4);
+
+        /*
+         * Latency: an input thread samples every 250 microseconds (4 kHz) while the game thread runs at 120 frames per second
+         * Latency is the time between sampling and the game thread applying the event
+         */
+        auto dispatcher = std::make_unique<InputDispatcher>();
+        auto forward = 0.0f;
+        auto turn = 0.0f;
+        auto jumps = 0;
+        dispatcher->BindAxis("MoveForward", [&](float value) { forward = value; });
+        dispatcher->BindAxis("Turn", [&](float value) { turn += value; }, AxisCoalesce::Sum);
+        dispatcher->BindAction("Jump", InputEventType::Pressed, [&] { jumps++; });
+
+        std::atomic<bool> running{ true };
+        std::uint64_t dropped = 0;
+        std::thread inputThread([&]
+        {
+            const InternedName moveForward("MoveForward");
+            const InternedName turnName("Turn");
+            const InternedName jump("Jump");
+
+            auto next = std::chrono::steady_clock::now();
+            for (auto sample = 0; running.load(std::memory_order_relaxed); sample++)
+            {
+                dropped += !dispatcher->PostAxis(moveForward, static_cast<float>(sample % 100) / 100.0f);
+                dropped += !dispatcher->PostAxis(turnName, 0.1f);
+                if (sample % 100 == 0)
+                {
+                    dropped += !dispatcher->PostAction(jump, true);
+                }
+
+                next += std::chrono::microseconds(250);
+                std::this_thread::sleep_until(next);
+            }
+        });
+
+        InputDispatchStats total;
+        const auto frames = 120;
+        auto nextFrame = std::chrono::steady_clock::now();
+        Stopwatch stopwatch;
+        for (auto frame = 0; frame < frames; frame++)
+        {
+            nextFrame += std::chrono::microseconds(8333);
+            std::this_thread::sleep_until(nextFrame);
+
+            const auto stats = dispatcher->Dispatch();
+            total.events += stats.events;
+            total.totalLatencyNanoseconds += stats.totalLatencyNanoseconds;
+            total.maxLatencyNanoseconds = std::max(total.maxLatencyNanoseconds, stats.maxLatencyNanoseconds);
+        }
+        const auto seconds = stopwatch.ElapsedSeconds();
+
+        running = false;
+        inputThread.join();
+
+        std::cout << "Dispatcher: " << total.events / seconds << " events/s applied, " << dropped << " dropped" << std::endl;
+        std::cout << "Sample-to-apply latency: mean " << total.totalLatencyNanoseconds / std::max<std::size_t>(total.events, 1) / 1000.0
+            << " us, max " << total.maxLatencyNanoseconds / 1000.0 << " us (frame time 8333 us)" << std::endl;
+    }
+
+    /*
+     * Replication
+     */
+
+    // Stand-in for a UDP connection on the same machine: packets arrive a fixed number of ticks later, some never arrive
+    class LoopbackChannel
+    {
+    public:
+        LoopbackChannel(int latencyTicks, double lossRate, unsigned seed) : latencyTicks(latencyTicks), lossRate(lossRate), random(seed) {}
+
+        void Send(int tick, std::vector<std::uint8_t> packet)
+        {
+            if (std::uniform_real_distribution<double>(0.0, 1.0)(random) >= lossRate)
+            {
+                inFlight.push_back({ tick + latencyTicks, std::move(packet) });
+            }
+        }
+
+        bool Receive(int tick, std::vector<std::uint8_t>& packet)
+        {
+            if (inFlight.empty() || inFlight.front().arrivalTick > tick)
+            {
+                return false;
+            }
+            packet = std::move(inFlight.front().bytes);
+            inFlight.pop_front();
+            return true;
+        }
+
+    private:
+        struct Packet
+        {
+            int arrivalTick;
+            std::vector<std::uint8_t> bytes;
+        };
+
+        int latencyTicks;
+        double lossRate;
+        std::mt19937 random;
+        std::deque<Packet> inFlight;
+    };
+
+    void ReplicationRun(int characterCount)
+    {
+        const auto ticks = 90;
+        const auto tickRate = 30.0;
+
+        // Characters run around at up to 600 cm/s (the default MaxWalkSpeed), half of them stand still at any time
+        std::mt19937 random(characterCount);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::vector<CharacterState> states(characterCount);
+        for (auto& state : states)
+        {
+            state.locationX = unit(random) * 100000.0f;
+            state.locationY = unit(random) * 100000.0f;
+            state.locationZ = 96.0f;
+            state.yaw = unit(random) * 180.0f;
+        }
+
+        SnapshotSender sender;
+        SnapshotReceiver receiver;
+        LoopbackChannel downstream(2, 0.05, 1);
+        LoopbackChannel upstream(2, 0.05, 2);
+
+        // What the server sent with each sequence, to check what the client decoded
+        std::unordered_map<std::uint16_t, std::vector<ReplicatedCharacter>> sent;
+
+        std::vector<ReplicatedCharacter> characters(characterCount);
+        BitWriter writer;
+        std::vector<std::uint8_t> packet;
+        std::size_t totalBytes = 0;
+        std::size_t decoded = 0;
+        std::size_t mismatches = 0;
+        double encodeNanoseconds = 0.0;
+        double decodeNanoseconds = 0.0;
+        std::uint16_t sequence = 0;
+
+        for (auto tick = 0; tick < ticks; tick++)
+        {
+            for (auto i = 0; i < characterCount; i++)
+            {
+                auto& state = states[i];
+                const auto moving = (i + tick / 30) % 2 == 0;
+                if (moving)
+                {
+                    state.yaw += unit(random) * 10.0f;
+                    const auto radians = state.yaw * 3.14159265f / 180.0f;
+                    state.velocityX = std::cos(radians) * 600.0f;
+                    state.velocityY = std::sin(radians) * 600.0f;
+                    state.locationX += state.velocityX / static_cast<float>(tickRate);
+                    state.locationY += state.velocityY / static_cast<float>(tickRate);
+                }
+                else
+                {
+                    state.velocityX = 0.0f;
+                    state.velocityY = 0.0f;
+                }
+                characters[i] = { static_cast<std::uint32_t>(i), Quantize(state) };
+            }
+
+            Stopwatch encodeStopwatch;
+            writer.Reset();
+            sender.Encode(characters, writer);
+            const auto& encoded = writer.Finish();
+            encodeNanoseconds += encodeStopwatch.ElapsedNanoseconds();
+
+            // Only the encoding is timed, not handing the packet to the simulated network
+            downstream.Send(tick, encoded);
+            totalBytes += encoded.size();
+            sent[sequence++] = characters;
+
+            while (downstream.Receive(tick, packet))
+            {
+                Stopwatch decodeStopwatch;
+                const auto ok = receiver.Decode(packet.data(), packet.size());
+                decodeNanoseconds += decodeStopwatch.ElapsedNanoseconds();
+                if (!ok)
+                {
+                    continue;
+                }
+
+                decoded++;
+                const auto& expected = sent[receiver.GetLatestSequence()];
+                const auto& actual = receiver.GetCharacters();
+                mismatches += expected.size() != actual.size();
+                for (std::size_t i = 0; i < std::min(expected.size(), actual.size()); i++)
+                {
+                    mismatches += expected[i].id != actual[i].id || expected[i].state != actual[i].state;
+                }
+
+                // The acknowledgement travels back as 2 bytes
+                upstream.Send(tick, { static_cast<std::uint8_t>(receiver.GetLatestSequence()), static_cast<std::uint8_t>(receiver.GetLatestSequence() >> 8) });
+            }
+
+            while (upstream.Receive(tick, packet))
+            {
+                sender.Acknowledge(static_cast<std::uint16_t>(packet[0] | packet[1] << 8));
+            }
+        }
+
+        const auto bytesPerTick = static_cast<double>(totalBytes) / ticks;
+        const auto fullBytesPerTick = 37.0 * characterCount;
+        std::cout << characterCount << " characters: " << bytesPerTick << " bytes/tick per client (" << bytesPerTick / characterCount << " per character, "
+            << bytesPerTick * 8.0 * tickRate / 1000.0 << " kbps at " << tickRate << " Hz), full floats " << fullBytesPerTick << " bytes/tick ("
+            << fullBytesPerTick / bytesPerTick << "x larger)" << std::endl;
+        std::cout << "    encode " << encodeNanoseconds / ticks / characterCount << " ns/character, decode "
+            << decodeNanoseconds / std::max<std::size_t>(decoded, 1) / characterCount << " ns/character, "
+            << decoded << "/" << ticks << " snapshots decoded, " << mismatches << " mismatches" << std::endl;
+    }
+
+    void ReplicationBenchmark()
+    {
+        std::cout << "== Replication (5% loss, 2 tick latency each way) ==" << std::endl;
+
+        ReplicationRun(100);
+        ReplicationRun(1000);
+        ReplicationRun(10000);
+    }
+
+    /*
+     * Significance
+     */
+
+    // Stands in for what ACppProjectCharacter does every tick: input-driven rotation, movement, and the camera boom probing for walls
+    struct SimulatedCharacter
+    {
+        float location[3] = { 0.0f, 0.0f, 0.0f };
+        float velocity[3] = { 0.0f, 0.0f, 0.0f };
+        float yaw = 0.0f;
+        float armLength = 300.0f;
+        std::uint32_t seed = 1;
+
+        void Tick(float deltaSeconds)
+        {
+            // Turn a little, like TurnAtRate with BaseTurnRate 45
+            seed = seed * 1664525u + 1013904223u;
+            yaw += (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 45.0f * deltaSeconds;
+
+            // Accelerate towards MaxWalkSpeed along the facing direction
+            const auto radians = yaw * 3.14159265f / 180.0f;
+            const float target[2] = { std::cos(radians) * 600.0f, std::sin(radians) * 600.0f };
+            for (auto axis = 0; axis < 2; axis++)
+            {
+                velocity[axis] += (target[axis] - velocity[axis]) * std::min(1.0f, 8.0f * deltaSeconds);
+                location[axis] += velocity[axis] * deltaSeconds;
+            }
+
+            // The spring arm sweeps from the character towards the camera, here against made-up walls
+            auto length = 300.0f;
+            for (auto step = 1; step <= 64; step++)
+            {
+                const auto t = static_cast<float>(step) / 64.0f;
+                const auto x = location[0] - std::cos(radians) * 300.0f * t;
+                const auto y = location[1] - std::sin(radians) * 300.0f * t;
+                if (std::sin(x * 0.01f) * std::cos(y * 0.01f) > 0.98f)
+                {
+                    length = std::min(length, 300.0f * t);
+                }
+            }
+            armLength += (length - armLength) * std::min(1.0f, 10.0f * deltaSeconds);
+        }
+    };
+
+    void SignificanceRun(int characterCount, double budgetSeconds)
+    {
+        const auto frames = 120;
+        const auto deltaSeconds = 1.0f / 60.0f;
+
+        // Characters spread over a 400 m square, the camera sits in the middle looking along X
+        std::mt19937 random(characterCount);
+        std::uniform_real_distribution<float> position(-20000.0f, 20000.0f);
+
+        std::vector<SimulatedCharacter> characters(characterCount);
+        SignificanceManager throttled;
+        SignificanceManager unthrottled;
+        std::vector<SignificanceManager::Handle> handles(characterCount);
+        for (auto i = 0; i < characterCount; i++)
+        {
+            auto& character = characters[i];
+            character.location[0] = position(random);
+            character.location[1] = position(random);
+            character.seed = static_cast<std::uint32_t>(i + 1);
+
+            const auto tick = [&character](float seconds) { character.Tick(seconds); };
+            handles[i] = throttled.Register(tick);
+            throttled.SetLocation(handles[i], character.location[0], character.location[1], character.location[2]);
+            unthrottled.Register(tick);
+        }
+
+        const SignificanceView view;
+
+        double total = 0.0;
+        double worst = 0.0;
+        for (auto frame = 0; frame < frames; frame++)
+        {
+            const auto stats = unthrottled.UpdateAll(deltaSeconds);
+            total += stats.seconds;
+            worst = std::max(worst, stats.seconds);
+        }
+        std::cout << characterCount << " characters, every frame: " << total / frames * 1000.0 << " ms/frame (max " << worst * 1000.0 << " ms)" << std::endl;
+
+        total = 0.0;
+        worst = 0.0;
+        std::size_t ticked = 0;
+        std::size_t deferred = 0;
+        auto stalest = 0;
+        SignificanceStats last;
+        for (auto frame = 0; frame < frames; frame++)
+        {
+            last = throttled.Update(view, deltaSeconds, budgetSeconds);
+            total += last.seconds;
+            worst = std::max(worst, last.seconds);
+            ticked += last.ticked;
+            deferred += last.deferred;
+            stalest = std::max(stalest, last.maxFramesSinceTick);
+
+            // The characters moved, tell the manager
+            for (auto i = 0; i < characterCount; i++)
+            {
+                throttled.SetLocation(handles[i], characters[i].location[0], characters[i].location[1], characters[i].location[2]);
+            }
+        }
+
+        std::cout << characterCount << " characters, throttled (" << budgetSeconds * 1000.0 << " ms budget): " << total / frames * 1000.0
+            << " ms/frame (max " << worst * 1000.0 << " ms), " << ticked / frames << " ticks/frame, " << deferred / frames
+            << " deferred/frame, stalest " << stalest << " frames, tiers";
+        for (auto tier = 0; tier < 4; tier++)
+        {
+            std::cout << " " << last.objectsPerTier[tier];
+        }
+        std::cout << std::endl;
+    }
+
+    void SignificanceBenchmark()
+    {
+        std::cout << "== Significance (120 frames at 60 Hz) ==" << std::endl;
+
+        for (auto count : { 100, 1000, 5000, 20000 })
+        {
+            SignificanceRun(count, 0.002);
+        }
+    }
+
+    /*
+     * Blend space
+     */
+
+    // UE4_Mannequin_Skeleton has 68 bones
+    constexpr int MannequinBoneCount = 68;
+
+    // Made-up keys: every bone swings around its own axis, a bit out of step with its parent
+    AnimationClip MakeSyntheticClip(int keyCount, float swingDegrees, std::uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        AnimationClip clip;
+        for (auto key = 0; key < keyCount; key++)
+        {
+            Pose pose(MannequinBoneCount);
+            for (auto bone = 0; bone < MannequinBoneCount; bone++)
+            {
+                const auto angle = swingDegrees * 3.14159265f / 180.0f * std::sin(6.2831853f * key / keyCount + bone * 0.3f) * 0.5f;
+                float axis[3] = { unit(random), unit(random), unit(random) };
+                const auto length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) + 1e-6f;
+
+                BoneTransform transform;
+                for (auto i = 0; i < 3; i++)
+                {
+                    transform.rotation[i] = axis[i] / length * std::sin(angle);
+                    transform.translation[i] = unit(random) * 10.0f;
+                }
+                transform.rotation[3] = std::cos(angle);
+                pose.SetBone(bone, transform);
+            }
+            clip.keys.push_back(std::move(pose));
+        }
+        return clip;
+    }
+
+    void BlendSpaceBenchmark()
+    {
+        std::cout << "== Blend space (" << MannequinBoneCount << " bones) ==" << std::endl;
+
+        const auto idle = MakeSyntheticClip(60, 10.0f, 1);
+        const auto walk = MakeSyntheticClip(32, 60.0f, 2);
+        const auto run = MakeSyntheticClip(22, 90.0f, 3);
+
+        // Direction on X, speed on Y: idle in the middle at 0, walking at 150 and running at 600 in five directions
+        BlendSpace2D blendSpace({ -180.0f, 180.0f, 4 }, { 0.0f, 600.0f, 4 });
+        blendSpace.AddSample(&idle, 0.0f, 0.0f);
+        for (auto direction : { -180.0f, -90.0f, 0.0f, 90.0f, 180.0f })
+        {
+            blendSpace.AddSample(&walk, direction, 150.0f);
+            blendSpace.AddSample(&run, direction, 600.0f);
+        }
+        blendSpace.Build();
+
+        // The pose blend on its own, the most sources Evaluate() ever blends
+        PoseSource sources[BlendSpace2D::MaxSources];
+        for (auto i = 0; i < BlendSpace2D::MaxSources; i++)
+        {
+            sources[i] = { &run.keys[i], 1.0f / BlendSpace2D::MaxSources };
+        }
+
+        Pose simd(MannequinBoneCount);
+        Pose scalar(MannequinBoneCount);
+        const auto blends = 200000;
+        Measure("BlendPoses, 8 sources", blends, [&]
+        {
+            for (auto i = 0; i < blends; i++)
+            {
+                BlendPoses(sources, BlendSpace2D::MaxSources, simd);
+            }
+        });
+        Measure("BlendPosesScalar, 8 sources", blends, [&]
+        {
+            for (auto i = 0; i < blends; i++)
+            {
+                BlendPosesScalar(sources, BlendSpace2D::MaxSources, scalar);
+            }
+        });
+
+        auto maxError = 0.0f;
+        for (auto channel = 0; channel < Pose::ChannelCount; channel++)
+        {
+            for (auto bone = 0; bone < MannequinBoneCount; bone++)
+            {
+                maxError = std::max(maxError, std::abs(simd.GetChannel(channel)[bone] - scalar.GetChannel(channel)[bone]));
+            }
+        }
+        std::cout << "SIMD vs scalar max difference: " << maxError << std::endl;
+
+        // Whole crowds: every character has its own speed, direction and phase
+        std::mt19937 random(4);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (auto count : { 1000, 5000, 10000 })
+        {
+            std::vector<BlendSpaceInput> inputs(count);
+            for (auto& input : inputs)
+            {
+                input = { unit(random) * 360.0f - 180.0f, unit(random) * 600.0f, unit(random) };
+            }
+            std::vector<Pose> outputs(count, Pose(MannequinBoneCount));
+
+            for (auto threads : { 1, HardwareThreads() })
+            {
+                ThreadPoolExecutor pool(threads);
+                const auto frames = 10;
+                Stopwatch stopwatch;
+                for (auto frame = 0; frame < frames; frame++)
+                {
+                    for (auto& input : inputs)
+                    {
+                        input.phase += 1.0f / 60.0f;
+                    }
+                    EvaluateBlendSpaces(blendSpace, inputs.data(), outputs.data(), inputs.size(), pool);
+                }
+                const auto seconds = stopwatch.ElapsedSeconds() / frames;
+
+                std::cout << count << " characters, " << threads << " thread(s): " << seconds * 1000.0 << " ms/frame, "
+                    << seconds * 1e9 / count << " ns/character" << std::endl;
+
+                if (threads == HardwareThreads())
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    /*
+     * Pathfinding
+     */
+
+    // Fills a rectangle of the height field, clipped to the map
+    template <typename Function>
+    void FillRect(HeightField& level, int x0, int y0, int width, int height, Function function)
+    {
+        for (auto y = std::max(y0, 0); y < std::min(y0 + height, level.GetHeight()); y++)
+        {
+            for (auto x = std::max(x0, 0); x < std::min(x0 + width, level.GetWidth()); x++)
+            {
+                function(x - x0, y - y0, x, y);
+            }
+        }
+    }
+
+    /*
+     * A level like the template's, scaled up: TemplateFloor everywhere, with walls, ramps, stairs and bumps scattered
+     * around, plus some things the capsule can't use (too steep, too low to fit under)
+     */
+    HeightField GenerateLevel(int size, unsigned seed)
+    {
+        const auto cellSize = 25.0f;
+        HeightField level(size, size, cellSize);
+
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> position(0, size - 1);
+        std::uniform_int_distribution<int> length(8, 40);
+        std::uniform_int_distribution<int> kind(0, 5);
+
+        const auto raise = [&level](int x, int y, float floor)
+        {
+            level.SetFloor(x, y, std::max(level.GetFloor(x, y), floor));
+        };
+
+        const auto features = size * size / 1500;
+        for (auto i = 0; i < features; i++)
+        {
+            const auto x0 = position(random);
+            const auto y0 = position(random);
+            const auto long_ = length(random);
+            const auto wide = length(random) / 2 + 4;
+
+            switch (kind(random))
+            {
+            case 0:
+                // Wall, long and thin
+                FillRect(level, x0, y0, random() % 2 ? long_ : 2, random() % 2 ? 2 : long_, [&](int, int, int x, int y) { raise(x, y, 300.0f); });
+                break;
+            case 1:
+                // Ramp_StaticMesh: 20 degrees up, then a platform at the top
+                FillRect(level, x0, y0, long_ + 8, wide, [&](int u, int, int x, int y)
+                {
+                    raise(x, y, std::min(u, long_) * cellSize * 0.364f);
+                });
+                break;
+            case 2:
+                // Linear_Stair_StaticMesh: 20 cm steps, two cells deep
+                FillRect(level, x0, y0, wide, long_ + 8, [&](int, int v, int x, int y)
+                {
+                    raise(x, y, std::min(v, long_) / 2 * 20.0f);
+                });
+                break;
+            case 3:
+                // Bump_StaticMesh, low enough to walk over
+                FillRect(level, x0, y0, wide, wide, [&](int, int, int x, int y) { raise(x, y, 10.0f); });
+                break;
+            case 4:
+                // A 60 degree slope, too steep to walk up
+                FillRect(level, x0, y0, long_, wide, [&](int u, int, int x, int y) { raise(x, y, u * cellSize * 1.732f); });
+                break;
+            default:
+                // A low ceiling, 150 cm doesn't fit the 192 cm capsule
+                FillRect(level, x0, y0, wide, wide, [&](int, int, int x, int y) { level.SetCeiling(x, y, level.GetFloor(x, y) + 150.0f); });
+                break;
+            }
+        }
+
+        return level;
+    }
+
+    std::vector<PathRequest> RandomPathRequests(const NavigationGrid& grid, int count, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> x(0, grid.GetWidth() - 1);
+        std::uniform_int_distribution<int> y(0, grid.GetHeight() - 1);
+
+        const auto randomWalkable = [&]
+        {
+            while (true)
+            {
+                const GridPoint point = { x(random), y(random) };
+                if (grid.IsWalkable(point.x, point.y))
+                {
+                    return point;
+                }
+            }
+        };
+
+        std::vector<PathRequest> requests;
+        for (auto i = 0; i < count; i++)
+        {
+            requests.push_back({ randomWalkable(), randomWalkable() });
+        }
+        return requests;
+    }
+
+    void PathfindingBenchmark()
+    {
+        const auto size = 512;
+        std::cout << "== Pathfinding (" << size << "x" << size << " cells of 25 cm) ==" << std::endl;
+
+        Stopwatch stopwatch;
+        auto level = GenerateLevel(size, 1);
+        NavigationGrid grid(level, AgentSettings());
+        std::cout << "Grid build: " << stopwatch.ElapsedSeconds() * 1000.0 << " ms, " << grid.GetRegions().size() << " regions" << std::endl;
+
+        auto walkableCells = 0;
+        for (auto y = 0; y < size; y++)
+        {
+            for (auto x = 0; x < size; x++)
+            {
+                walkableCells += grid.IsWalkable(x, y);
+            }
+        }
+        std::cout << "Walkable: " << 100.0 * walkableCells / (size * size) << "% of cells" << std::endl;
+
+        // The three searches on the same requests: queries per second, how much they searched and how long the paths are
+        const auto requests = RandomPathRequests(grid, 500, 2);
+        PathFinder finder(grid);
+        std::vector<PathResult> optimal;
+
+        const auto run = [&](const char* label, auto find)
+        {
+            std::size_t expanded = 0;
+            std::size_t found = 0;
+            double longer = 0.0;
+            double totalLonger = 0.0;
+            std::vector<PathResult> results;
+
+            Stopwatch searchStopwatch;
+            for (const auto& request : requests)
+            {
+                results.push_back(find(request));
+            }
+            const auto seconds = searchStopwatch.ElapsedSeconds();
+
+            for (std::size_t i = 0; i < results.size(); i++)
+            {
+                expanded += results[i].expanded;
+                found += results[i].found;
+                if (!optimal.empty() && results[i].found && optimal[i].found)
+                {
+                    const auto excess = optimal[i].length > 0.0f ? static_cast<double>(results[i].length / optimal[i].length) - 1.0 : 0.0;
+                    longer = std::max(longer, excess);
+                    totalLonger += excess;
+                }
+            }
+
+            std::cout << label << ": " << requests.size() / seconds << " queries/s, " << expanded / requests.size() << " cells opened per query, "
+                << found << "/" << requests.size() << " found";
+            if (!optimal.empty())
+            {
+                std::cout << ", " << totalLonger / found * 100.0 << "% longer than A* on average (at most " << longer * 100.0 << "%)";
+            }
+            std::cout << std::endl;
+
+            if (optimal.empty())
+            {
+                optimal = std::move(results);
+            }
+        };
+
+        run("A*", [&](const PathRequest& request) { return finder.FindPathAStar(request.start, request.goal); });
+        run("Jump Point Search", [&](const PathRequest& request) { return finder.FindPath(request.start, request.goal, false); });
+        run("Jump Point Search, hierarchical", [&](const PathRequest& request) { return finder.FindPath(request.start, request.goal, true); });
+
+        // The service: many AIs asking for the same few hundred paths over and over, in batches
+        std::vector<PathRequest> hotRequests;
+        {
+            const auto popular = RandomPathRequests(grid, 400, 3);
+            std::mt19937 random(4);
+            std::geometric_distribution<int> pick(0.01);
+            for (auto i = 0; i < 20000; i++)
+            {
+                hotRequests.push_back(popular[std::min<std::size_t>(pick(random), popular.size() - 1)]);
+            }
+        }
+
+        for (auto threads : { 1, HardwareThreads() })
+        {
+            PathfindingService service(grid, threads, 4096);
+
+            Stopwatch serviceStopwatch;
+            for (std::size_t start = 0; start < hotRequests.size(); start += 1000)
+            {
+                const std::vector<PathRequest> batch(hotRequests.begin() + start, hotRequests.begin() + start + 1000);
+                service.FindPaths(batch);
+            }
+            const auto seconds = serviceStopwatch.ElapsedSeconds();
+            const auto stats = service.GetCache().GetStats();
+
+            std::cout << "PathfindingService, " << threads << " thread(s): " << hotRequests.size() / seconds << " queries/s, cache hit rate "
+                << 100.0 * stats.hits / std::max<std::size_t>(stats.hits + stats.misses, 1) << "%" << std::endl;
+
+            if (threads == HardwareThreads())
+            {
+                // A wall appears in the middle of the map, only paths through there are thrown away
+                const GridPoint min = { size / 2 - 20, size / 2 - 1 };
+                const GridPoint max = { size / 2 + 20, size / 2 + 1 };
+                FillRect(level, min.x, min.y, max.x - min.x + 1, max.y - min.y + 1, [&](int, int, int x, int y) { level.SetFloor(x, y, 300.0f); });
+
+                const auto cached = service.GetCache().Num();
+                Stopwatch updateStopwatch;
+                service.UpdateRegion(level, min, max);
+                std::cout << "UpdateRegion: " << updateStopwatch.ElapsedSeconds() * 1000.0 << " ms, " << cached - service.GetCache().Num()
+                    << " of " << cached << " cached paths invalidated" << std::endl;
+                break;
+            }
+        }
+    }
+
+    /*
+     * Package scanning
+     */
+
+    // The template's Content folder, looked for from the working directory upwards
+    std::filesystem::path FindContentFolder()
+    {
+        std::error_code error;
+        for (auto folder = std::filesystem::current_path(error); !error && !folder.empty(); folder = folder.parent_path())
+        {
+            const auto content = folder / "ue4" / "CppProject" / "Content";
+            if (std::filesystem::is_directory(content, error))
+            {
+                return content;
+            }
+            if (folder == folder.parent_path())
+            {
+                break;
+            }
+        }
+        return {};
+    }
+
+    /*
+     * A made-up Content folder: 'count' packages in folders of 100, each importing a few of the others and some engine modules.
+     * 8 KB of object data each, real packages are bigger but this keeps 100K files under a gigabyte.
+     */
+    void WriteSyntheticContent(const std::filesystem::path& root, int count)
+    {
+        std::mt19937 random(5);
+        const auto packageName = [](int i) { return "/Game/Synthetic/Folder" + std::to_string(i / 100) + "/Asset" + std::to_string(i); };
+
+        for (auto i = 0; i < count; i++)
+        {
+            std::vector<PackageImport> imports = {
+                { "/Script/CoreUObject", "Package", "/Script/CoreUObject", 0 },
+                { "/Script/CoreUObject", "Package", "/Script/Engine", 0 },
+                { "/Script/CoreUObject", "Class", "StaticMesh", -2 },
+            };
+            const auto dependencyCount = static_cast<int>(random() % 6);
+            for (auto j = 0; j < dependencyCount; j++)
+            {
+                imports.push_back({ "/Script/CoreUObject", "Package", packageName(static_cast<int>(random() % count)), 0 });
+            }
+            const std::vector<PackageExport> exports = { { "StaticMesh", "Asset" + std::to_string(i), 0 } };
+
+            const auto folder = root / ("Folder" + std::to_string(i / 100));
+            if (i % 100 == 0)
+            {
+                std::filesystem::create_directories(folder);
+            }
+
+            const auto bytes = WritePackage(imports, exports, 8192);
+            std::ofstream file(folder / ("Asset" + std::to_string(i) + ".uasset"), std::ios::binary);
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+    }
+
+    void ScanRun(const char* label, const std::filesystem::path& root)
+    {
+        std::cout << "-- " << label << " --" << std::endl;
+
+        const auto report = [](const std::string& name, double seconds, const ScanStats& stats)
+        {
+            std::cout << name << ": " << seconds * 1000.0 << " ms, " << stats.files / seconds << " files/s, " << stats.bytesRead / seconds / 1e6 << " MB/s read ("
+                << stats.parsed << " read, " << stats.rehashed << " known by hash, " << stats.unchanged << " unchanged)" << std::endl;
+        };
+
+        // Cold means without an index, the operating system may still have the files cached from an earlier run
+        ScanStats stats;
+        for (auto threads : { 1, HardwareThreads() })
+        {
+            DependencyIndex index;
+            Stopwatch stopwatch;
+            stats = index.Scan(root.string(), threads);
+            report("Cold, " + std::to_string(threads) + " thread(s)", stopwatch.ElapsedSeconds(), stats);
+
+            if (threads == HardwareThreads())
+            {
+                break;
+            }
+        }
+
+        const auto indexPath = (std::filesystem::temp_directory_path() / "CppForDummiesIndex.tsv").string();
+        {
+            DependencyIndex index;
+            index.Scan(root.string(), HardwareThreads());
+            Stopwatch stopwatch;
+            index.Save(indexPath);
+            std::cout << "Save index: " << stopwatch.ElapsedSeconds() * 1000.0 << " ms, " << std::filesystem::file_size(indexPath) / 1024 << " KB" << std::endl;
+        }
+
+        // Warm: everything comes from the index, only the file sizes and times are checked
+        DependencyIndex index;
+        Stopwatch loadStopwatch;
+        index.Load(indexPath);
+        std::cout << "Load index: " << loadStopwatch.ElapsedSeconds() * 1000.0 << " ms" << std::endl;
+
+        Stopwatch warmStopwatch;
+        stats = index.Scan(root.string(), HardwareThreads());
+        report("Warm, " + std::to_string(HardwareThreads()) + " thread(s)", warmStopwatch.ElapsedSeconds(), stats);
+
+        // Touching files (like a source control sync does) makes them hash again, but not be read again
+        auto touched = 0;
+        const auto now = std::filesystem::file_time_type::clock::now();
+        for (const auto& package : index.GetPackages())
+        {
+            if (touched++ % 10 == 0)
+            {
+                std::error_code error;
+                std::filesystem::last_write_time(root / package.path, now, error);
+            }
+        }
+
+        Stopwatch touchedStopwatch;
+        stats = index.Scan(root.string(), HardwareThreads());
+        report("10% touched", touchedStopwatch.ElapsedSeconds(), stats);
+
+        std::filesystem::remove(indexPath);
+    }
+
+    void SyntheticScanRun(int count)
+    {
+        const auto root = std::filesystem::temp_directory_path() / ("CppForDummiesContent" + std::to_string(count));
+        std::filesystem::remove_all(root);
+
+        Stopwatch stopwatch;
+        WriteSyntheticContent(root, count);
+        std::cout << "Wrote " << count << " synthetic packages in " << stopwatch.ElapsedSeconds() << " s" << std::endl;
+
+        ScanRun(("Synthetic, " + std::to_string(count) + " packages").c_str(), root);
+        std::filesystem::remove_all(root);
+    }
+
+    void PackageScanBenchmark()
+    {
+        std::cout << "== Package scanning ==" << std::endl;
+
+        const auto content = FindContentFolder();
+        if (content.empty())
+        {
+            std::cout << "ue4/CppProject/Content not found, run from inside the repository to scan the real packages" << std::endl;
+        }
+        else
+        {
+            ScanRun("ue4/CppProject/Content", content);
+        }
+
+        SyntheticScanRun(10000);
+    }
+
+    void PackageScanLargeBenchmark()
+    {
+        std::cout << "== Package scanning (100K packages) ==" << std::endl;
+        SyntheticScanRun(100000);
+    }
+
+    /*
+     * Fixed-size array algorithms
+     */
+
+    // 16K elements in arrays of N, small enough to stay in the cache so the algorithms are measured, not memory
+    template <typename T, std::size_t N>
+    std::vector<std::array<T, N>> RandomArrays(unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> values(-100000, 100000);
+
+        std::vector<std::array<T, N>> arrays(std::max<std::size_t>(16384 / N, 16));
+        for (auto& array : arrays)
+        {
+            for (auto& value : array)
+            {
+                value = static_cast<T>(values(random));
+            }
+        }
+        return arrays;
+    }
+
+    template <typename T, std::size_t N, typename Function>
+    double CallForArray(const Function& function, const std::array<T, N>& array)
+    {
+        return static_cast<double>(function(array));
+    }
+
+    /*
+     * Nanoseconds per array, the results are added up so the compiler can't skip any of the work
+     * Every call goes through a volatile function pointer, so the compiler can't inline it into this loop and
+     * both sides are compiled the same way: as a standalone function, like in real code.
+     */
+    template <typename T, std::size_t N, typename Function>
+    double ArrayTime(const std::vector<std::array<T, N>>& arrays, int repeats, const Function& function)
+    {
+        using Call = double (*)(const Function&, const std::array<T, N>&);
+        volatile Call call = &CallForArray<T, N, Function>;
+
+        double total = 0.0;
+        Stopwatch stopwatch;
+        for (auto repeat = 0; repeat < repeats; repeat++)
+        {
+            for (const auto& array : arrays)
+            {
+                total += call(function, array);
+            }
+        }
+        const auto nanoseconds = stopwatch.ElapsedNanoseconds() / (static_cast<double>(repeats) * arrays.size());
+        sink = sink + static_cast<std::size_t>(total != 0.0);
+        return nanoseconds;
+    }
+
+    template <typename T, std::size_t N, typename Standard, typename Fixed>
+    void ArrayCompare(const char* label, const char* standardName, const char* fixedName, const std::vector<std::array<T, N>>& arrays, int repeats,
+        Standard standard, Fixed fixed)
+    {
+        // One untimed pass each warms up the caches, then the two take turns going first so neither always gets the warmer start
+        ArrayTime(arrays, 1, standard);
+        ArrayTime(arrays, 1, fixed);
+
+        const auto rounds = std::min(repeats, 4);
+        auto standardTime = 0.0;
+        auto fixedTime = 0.0;
+        for (auto round = 0; round < rounds; round++)
+        {
+            const auto roundRepeats = repeats / rounds + (round < repeats % rounds ? 1 : 0);
+            if (round % 2 == 0)
+            {
+                standardTime += ArrayTime(arrays, roundRepeats, standard) * roundRepeats;
+                fixedTime += ArrayTime(arrays, roundRepeats, fixed) * roundRepeats;
+            }
+            else
+            {
+                fixedTime += ArrayTime(arrays, roundRepeats, fixed) * roundRepeats;
+                standardTime += ArrayTime(arrays, roundRepeats, standard) * roundRepeats;
+            }
+        }
+        standardTime /= repeats;
+        fixedTime /= repeats;
+
+        std::cout << "N=" << N << " " << label << ": " << standardName << " " << standardTime << " ns, " << fixedName << " " << fixedTime << " ns ("
+            << standardTime / fixedTime << "x)" << std::endl;
+    }
+
+    template <std::size_t N>
+    void ArraySizeRun()
+    {
+        const auto ints = RandomArrays<int, N>(static_cast<unsigned>(N));
+        const auto floats = RandomArrays<float, N>(static_cast<unsigned>(N) + 1);
+
+        // Every array is processed about 4M elements worth of times, sorting a quarter of that
+        const auto repeats = static_cast<int>(std::max<std::size_t>((1 << 22) / (ints.size() * N), 1));
+
+        // No sum<int>: for integers ArraySum is the same plain loop as std::accumulate (lanes were slower), nothing to compare
+        ArrayCompare("sum<float>", "std::accumulate", "ArraySum", floats, repeats,
+            [](const auto& values) { return std::accumulate(values.begin(), values.end(), 0.0f); },
+            [](const auto& values) { return ArraySum(values); });
+
+        ArrayCompare("max<int>", "std::max_element", "ArrayMax", ints, repeats,
+            [](const auto& values) { return *std::max_element(values.begin(), values.end()); },
+            [](const auto& values) { return ArrayMax(values); });
+
+        ArrayCompare("minmax<float>", "std::minmax_element", "ArrayMinMax", floats, repeats,
+            [](const auto& values)
+            {
+                const auto [smallest, biggest] = std::minmax_element(values.begin(), values.end());
+                return *biggest - *smallest;
+            },
+            [](const auto& values)
+            {
+                const auto [smallest, biggest] = ArrayMinMax(values);
+                return biggest - smallest;
+            });
+
+        // Looking for the last element, so the whole array is searched
+        ArrayCompare("find<int>", "std::find", "ArrayFind", ints, repeats,
+            [](const auto& values) { return std::find(values.begin(), values.end(), values[N - 1]) - values.begin(); },
+            [](const auto& values) { return ArrayFind(values, values[N - 1]); });
+
+        // Results go into memory that's read afterwards, otherwise only the one element that's returned would be computed
+        std::vector<std::array<float, N>> scaled(floats.size());
+        ArrayCompare("transform<float>", "std::transform", "ArrayTransform", floats, repeats,
+            [&](const auto& values)
+            {
+                auto& destination = scaled[&values - floats.data()];
+                std::transform(values.begin(), values.end(), destination.begin(), [](float value) { return value * 0.5f + 1.0f; });
+                return destination[0];
+            },
+            [&](const auto& values)
+            {
+                auto& destination = scaled[&values - floats.data()];
+                destination = ArrayTransform(values, [](float value) { return value * 0.5f + 1.0f; });
+                return destination[0];
+            });
+        sink = sink + static_cast<std::size_t>(scaled[scaled.size() / 2][N / 2]);
+
+        // Both sort a copy, so the copy costs the same on both sides
+        ArrayCompare("sort<int>", "std::sort", "ArraySort", ints, std::max(repeats / 4, 1),
+            [](const auto& values)
+            {
+                auto sorted = values;
+                std::sort(sorted.begin(), sorted.end());
+                return sorted[N / 2];
+            },
+            [](const auto& values) { return ArraySort(values)[N / 2]; });
+
+        ArrayCompare("sort<float>", "std::sort", "ArraySort", floats, std::max(repeats / 4, 1),
+            [](const auto& values)
+            {
+                auto sorted = values;
+                std::sort(sorted.begin(), sorted.end());
+                return sorted[N / 2];
+            },
+            [](const auto& values) { return ArraySort(values)[N / 2]; });
+    }
+
+    void ArrayAlgorithmsBenchmark()
+    {
+        std::cout << "== Fixed-size array algorithms (time per array) ==" << std::endl;
+        ArraySizeRun<4>();
+        ArraySizeRun<8>();
+        ArraySizeRun<16>();
+        ArraySizeRun<32>();
+        ArraySizeRun<64>();
+        ArraySizeRun<128>();
+        ArraySizeRun<256>();
+    }
+
+    /*
+     * Shared state
+     */
+
+    // The same interface as ConcurrentDummyClass, with every access behind one lock
+    template <typename Mutex, typename ReadLock>
+    class LockedDummyClass
+    {
+    public:
+        explicit LockedDummyClass(MyDummyClass& object)
+            : object(object)
+        {
+        }
+
+        DummySnapshot GetSnapshot() const
+        {
+            ReadLock lock(mutex);
+            return { object.num, object.GetPrivateNum() };
+        }
+
+        template <typename Function>
+        void Update(Function&& change)
+        {
+            std::unique_lock lock(mutex);
+            change(object);
+        }
+
+    private:
+        MyDummyClass& object;
+        mutable Mutex mutex;
+    };
+
+    struct SharedStateResult
+    {
+        double readsPerSecond = 0.0;
+        double writesPerSecond = 0.0;
+        std::uint64_t mismatches = 0;
+    };
+
+    // 'readerCount' threads read as fast as they can while one thread keeps updating, for a fixed time
+    template <typename Shared>
+    SharedStateResult SharedStateRun(MyDummyClass& object, int readerCount, std::chrono::milliseconds duration)
+    {
+        // Readers expect privateNum == num * 2, a new MyDummyClass starts at 5 and 3
+        object.num = 0;
+        object.SetPrivateNum(0);
+        Shared shared(object);
+        std::atomic<bool> started{ false };
+        std::atomic<bool> running{ true };
+        std::atomic<std::uint64_t> reads{ 0 };
+        std::atomic<std::uint64_t> mismatches{ 0 };
+
+        std::vector<std::thread> readers;
+        for (auto i = 0; i < readerCount; i++)
+        {
+            readers.emplace_back([&]
+            {
+                while (!started.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+
+                std::uint64_t count = 0;
+                std::uint64_t mismatched = 0;
+                while (running.load(std::memory_order_relaxed))
+                {
+                    const auto snapshot = shared.GetSnapshot();
+                    mismatched += snapshot.privateNum != snapshot.num * 2;
+                    count++;
+                }
+                reads += count;
+                mismatches += mismatched;
+            });
+        }
+
+        std::uint64_t writes = 0;
+        std::thread writer([&]
+        {
+            while (!started.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            for (auto i = 1; running.load(std::memory_order_relaxed); i++)
+            {
+                shared.Update([i](MyDummyClass& dummy)
+                {
+                    dummy.num = i;
+                    dummy.SetPrivateNum(i * 2);
+                });
+                writes++;
+            }
+        });
+
+        Stopwatch stopwatch;
+        started.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(duration);
+        running = false;
+        writer.join();
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+        const auto seconds = stopwatch.ElapsedSeconds();
+
+        return { reads.load() / seconds, writes / seconds, mismatches.load() };
+    }
+
+    void SharedStateBenchmark()
+    {
+        std::cout << "== Shared state (one writer, many readers) ==" << std::endl;
+        std::cout << "Hardware threads: " << HardwareThreads() << std::endl;
+
+        using MutexDummyClass = LockedDummyClass<std::mutex, std::unique_lock<std::mutex>>;
+        using SharedMutexDummyClass = LockedDummyClass<std::shared_mutex, std::shared_lock<std::shared_mutex>>;
+
+        MyDummyClass object;
+        const auto duration = std::chrono::milliseconds(100);
+
+        for (auto readers : { 1, 2, 4, 8, 16, 32, 64 })
+        {
+            const auto report = [readers](const char* label, const SharedStateResult& result)
+            {
+                std::cout << readers << " reader(s), " << label << ": " << result.readsPerSecond / 1e6 << " M reads/s, "
+                    << result.writesPerSecond / 1e6 << " M writes/s, " << result.mismatches << " torn reads" << std::endl;
+            };
+
+            report("std::mutex", SharedStateRun<MutexDummyClass>(object, readers, duration));
+            report("std::shared_mutex", SharedStateRun<SharedMutexDummyClass>(object, readers, duration));
+            report("ConcurrentDummyClass", SharedStateRun<ConcurrentDummyClass>(object, readers, duration));
+        }
+    }
+
+    /*
+     * Saving and loading
+     */
+
+    // Looks like real saved objects: ids that mostly go up by one, small private numbers, one in ten a BetterDummyClass
+    DummyRecord MakeDummyRecord(std::uint64_t row)
+    {
+        auto hash = row * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 29;
+
+        DummyRecord record;
+        record.num = static_cast<int>(row + row / 1000);
+        record.privateNum = static_cast<int>(hash % 1000);
+        record.protectedNum = 2;
+        record.type = hash % 10 == 0 ? DummyType::BetterDummyClass : DummyType::MyDummyClass;
+        return record;
+    }
+
+    std::uint64_t Checksum(std::uint64_t checksum, const DummyRecord& record)
+    {
+        return checksum * 31 + static_cast<std::uint32_t>(record.num) + static_cast<std::uint32_t>(record.privateNum) * 7
+            + static_cast<std::uint32_t>(record.protectedNum) * 13 + static_cast<std::uint32_t>(record.type);
+    }
+
+    struct SaveLoadResult
+    {
+        double saveSeconds = 0.0;
+        double loadSeconds = 0.0;
+        std::uintmax_t fileSize = 0;
+        bool matches = false;
+    };
+
+    template <typename Save, typename Load>
+    SaveLoadResult SaveLoadRun(const std::string& path, std::uint64_t rows, Save&& save, Load&& load)
+    {
+        std::uint64_t expected = 0;
+        for (std::uint64_t row = 0; row < rows; row++)
+        {
+            expected = Checksum(expected, MakeDummyRecord(row));
+        }
+
+        SaveLoadResult result;
+        Stopwatch saveStopwatch;
+        save();
+        result.saveSeconds = saveStopwatch.ElapsedSeconds();
+        result.fileSize = std::filesystem::file_size(path);
+
+        Stopwatch loadStopwatch;
+        result.matches = load() == expected;
+        result.loadSeconds = loadStopwatch.ElapsedSeconds();
+
+        std::filesystem::remove(path);
+        return result;
+    }
+
+    void ReportSaveLoad(const char* label, std::uint64_t rows, const SaveLoadResult& result)
+    {
+        // Measured against the size of the objects' data, so formats that store less don't look slower
+        const auto bytes = static_cast<double>(rows * 4 * sizeof(std::int32_t));
+        std::cout << label << ": save " << bytes / result.saveSeconds / 1e9 << " GB/s, load " << bytes / result.loadSeconds / 1e9
+            << " GB/s, " << result.fileSize / 1e6 << " MB" << (result.matches ? "" : " (MISMATCH)") << std::endl;
+    }
+
+    SaveLoadResult ArchiveRun(const std::string& path, std::uint64_t rows, const DummyArchiveOptions& options)
+    {
+        return SaveLoadRun(path, rows, [&]
+        {
+            DummyArchiveWriter writer;
+            std::string error;
+            writer.Open(path, options, error);
+            for (std::uint64_t row = 0; row < rows; row++)
+            {
+                writer.Write(MakeDummyRecord(row));
+            }
+            if (!writer.Close(error))
+            {
+                std::cout << error << std::endl;
+            }
+        },
+        [&]
+        {
+            DummyArchiveReader reader;
+            std::string error;
+            if (!reader.Open(path, error))
+            {
+                std::cout << error << std::endl;
+                return std::uint64_t{ 0 };
+            }
+
+            std::uint64_t checksum = 0;
+            std::vector<DummyRecord> records;
+            for (std::size_t group = 0; group < reader.GetGroupCount(); group++)
+            {
+                reader.ReadRecords(group, records);
+                for (const auto& record : records)
+                {
+                    checksum = Checksum(checksum, record);
+                }
+            }
+            return checksum;
+        });
+    }
+
+    void SaveLoad(std::uint64_t rows, bool withIostream)
+    {
+        std::cout << rows / 1e6 << " M objects (" << rows * 16 / 1e6 << " MB of data), loading from the page cache" << std::endl;
+        const auto path = (std::filesystem::temp_directory_path() / "CppForDummiesDummies.bin").string();
+
+        if (withIostream)
+        {
+            ReportSaveLoad("iostream text (<< and >>)", rows, SaveLoadRun(path, rows, [&]
+            {
+                std::ofstream out(path);
+                for (std::uint64_t row = 0; row < rows; row++)
+                {
+                    const auto record = MakeDummyRecord(row);
+                    out << record.num << ' ' << record.privateNum << ' ' << record.protectedNum << ' ' << static_cast<int>(record.type) << '\n';
+                }
+            },
+            [&]
+            {
+                std::ifstream in(path);
+                std::uint64_t checksum = 0;
+                DummyRecord record;
+                int type;
+                while (in >> record.num >> record.privateNum >> record.protectedNum >> type)
+                {
+                    record.type = static_cast<DummyType>(type);
+                    checksum = Checksum(checksum, record);
+                }
+                return checksum;
+            }));
+
+            ReportSaveLoad("iostream binary (write and read per object)", rows, SaveLoadRun(path, rows, [&]
+            {
+                std::ofstream out(path, std::ios::binary);
+                for (std::uint64_t row = 0; row < rows; row++)
+                {
+                    const auto record = MakeDummyRecord(row);
+                    out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+                }
+            },
+            [&]
+            {
+                std::ifstream in(path, std::ios::binary);
+                std::uint64_t checksum = 0;
+                DummyRecord record;
+                while (in.read(reinterpret_cast<char*>(&record), sizeof(record)))
+                {
+                    checksum = Checksum(checksum, record);
+                }
+                return checksum;
+            }));
+        }
+
+        DummyArchiveOptions raw;
+        raw.encodings.fill(DummyEncoding::Raw);
+        ReportSaveLoad("DummyArchive, raw columns", rows, ArchiveRun(path, rows, raw));
+        ReportSaveLoad("DummyArchive, delta + bitpacked", rows, ArchiveRun(path, rows, {}));
+
+        // Raw columns don't need loading at all, they're used straight from the mapped file
+        {
+            DummyArchiveWriter writer;
+            std::string error;
+            writer.Open(path, raw, error);
+            for (std::uint64_t row = 0; row < rows; row++)
+            {
+                writer.Write(MakeDummyRecord(row));
+            }
+            writer.Close(error);
+
+            Stopwatch stopwatch;
+            DummyArchiveReader reader;
+            reader.Open(path, error);
+            std::int64_t total = 0;
+            for (std::size_t group = 0; group < reader.GetGroupCount(); group++)
+            {
+                for (auto value : reader.GetRawColumn(group, DummyColumn::PrivateNum))
+                {
+                    total += value;
+                }
+            }
+            const auto seconds = stopwatch.ElapsedSeconds();
+            sink = sink + static_cast<std::size_t>(total);
+            std::cout << "DummyArchive, summing one raw column in place: " << rows * sizeof(std::int32_t) / seconds / 1e9 << " GB/s" << std::endl;
+
+            reader.Close();
+            std::filesystem::remove(path);
+        }
+    }
+
+    void DummyArchiveBenchmark()
+    {
+        std::cout << "== Saving and loading MyDummyClass objects ==" << std::endl;
+        SaveLoad(4000000, true);
+    }
+
+    void DummyArchiveLargeBenchmark()
+    {
+        std::cout << "== Saving and loading MyDummyClass objects, 200 M ==" << std::endl;
+        SaveLoad(200000000, false);
+    }
+
+    /*
+     * Numeric types
+     */
+
+    // Characters spread over a level (in cm, like UE4) moving at up to MaxWalkSpeed 600
+    struct MovementState
+    {
+        std::vector<double> positions;
+        std::vector<double> velocities;
+    };
+
+    MovementState MakeMovementState(std::size_t count)
+    {
+        std::mt19937 random(39);
+        std::uniform_real_distribution<double> position(-20000.0, 20000.0);
+        std::uniform_real_distribution<double> velocity(-600.0, 600.0);
+
+        MovementState state;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            state.positions.push_back(position(random));
+            state.velocities.push_back(velocity(random));
+        }
+        return state;
+    }
+
+    // Runs 'frames' frames in type T and reports how far it ends up from the same run in double
+    template <typename T, typename FromDouble, typename ToDouble, typename Step>
+    void NumericAccuracyRun(const char* label, const MovementState& state, const std::vector<double>& reference, int frames,
+        FromDouble fromDouble, ToDouble toDouble, Step step)
+    {
+        std::vector<T> positions;
+        std::vector<T> velocities;
+        for (std::size_t i = 0; i < reference.size(); i++)
+        {
+            positions.push_back(fromDouble(state.positions[i]));
+            velocities.push_back(fromDouble(state.velocities[i]));
+        }
+        for (auto frame = 0; frame < frames; frame++)
+        {
+            step(positions, velocities);
+        }
+
+        double maxError = 0.0;
+        double totalError = 0.0;
+        for (std::size_t i = 0; i < reference.size(); i++)
+        {
+            const auto error = std::abs(toDouble(positions[i]) - reference[i]);
+            maxError = std::max(maxError, error);
+            totalError += error;
+        }
+        std::cout << label << " (" << sizeof(T) << " bytes): mean error " << totalError / reference.size() << " cm, max " << maxError << " cm" << std::endl;
+    }
+
+    void NumericAccuracy()
+    {
+        const std::size_t count = 100000;
+        const auto frames = 600;
+        const auto deltaSeconds = 1.0 / 60.0;
+        const auto state = MakeMovementState(count);
+
+        std::cout << count << " characters within +-200 m, 10 seconds at 60 frames per second, compared against double" << std::endl;
+
+        auto reference = state.positions;
+        for (auto frame = 0; frame < frames; frame++)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                reference[i] += state.velocities[i] * deltaSeconds;
+            }
+        }
+
+        NumericAccuracyRun<float>("float", state, reference, frames,
+            [](double value) { return static_cast<float>(value); }, [](float value) { return static_cast<double>(value); },
+            [&](std::vector<float>& positions, const std::vector<float>& velocities)
+            {
+                for (std::size_t i = 0; i < positions.size(); i++)
+                {
+                    positions[i] += velocities[i] * static_cast<float>(deltaSeconds);
+                }
+            });
+
+        NumericAccuracyRun<Fixed16>("Fixed16 (Q16.16)", state, reference, frames,
+            [](double value) { return Fixed16::FromFloat(value / 100.0); }, [](Fixed16 value) { return value.ToDouble() * 100.0; },
+            [&](std::vector<Fixed16>& positions, const std::vector<Fixed16>& velocities)
+            {
+                Integrate(positions.data(), velocities.data(), Fixed16::FromFloat(deltaSeconds), positions.size());
+            });
+
+        NumericAccuracyRun<Fixed32>("Fixed32 (Q32.32)", state, reference, frames,
+            [](double value) { return Fixed32::FromFloat(value); }, [](Fixed32 value) { return value.ToDouble(); },
+            [&](std::vector<Fixed32>& positions, const std::vector<Fixed32>& velocities)
+            {
+                const auto delta = Fixed32::FromFloat(deltaSeconds);
+                for (std::size_t i = 0; i < positions.size(); i++)
+                {
+                    positions[i] += velocities[i] * delta;
+                }
+            });
+
+        NumericAccuracyRun<Half>("Half", state, reference, frames,
+            [](double value) { return Half::FromFloat(static_cast<float>(value / 100.0)); }, [](Half value) { return value.ToFloat() * 100.0; },
+            [&](std::vector<Half>& positions, const std::vector<Half>& velocities)
+            {
+                Integrate(positions.data(), velocities.data(), static_cast<float>(deltaSeconds), positions.size());
+            });
+
+        NumericAccuracyRun<BFloat16>("BFloat16", state, reference, frames,
+            [](double value) { return BFloat16::FromFloat(static_cast<float>(value)); }, [](BFloat16 value) { return static_cast<double>(value.ToFloat()); },
+            [&](std::vector<BFloat16>& positions, const std::vector<BFloat16>& velocities)
+            {
+                Integrate(positions.data(), velocities.data(), static_cast<float>(deltaSeconds), positions.size());
+            });
+
+        std::cout << "(Fixed16 and Half store meters, centimeters don't fit their range)" << std::endl;
+        std::cout << "(A frame's step is smaller than the gap between 16 bit values this far out, so Half and BFloat16 are for storing results, not adding up)" << std::endl;
+    }
+
+    template <typename Function>
+    double ValuesPerSecond(std::size_t count, int repeats, Function function)
+    {
+        Stopwatch stopwatch;
+        for (auto repeat = 0; repeat < repeats; repeat++)
+        {
+            function();
+        }
+        return static_cast<double>(count) * repeats / stopwatch.ElapsedSeconds();
+    }
+
+    void NumericThroughput()
+    {
+        // Small enough to stay in the cache, so this measures the math and not the memory
+        const std::size_t count = 16384;
+        const auto repeats = 5000;
+        const auto deltaSeconds = 1.0f / 60.0f;
+        const auto state = MakeMovementState(count);
+
+        std::vector<double> doubles(state.positions);
+        std::vector<float> floats(state.positions.begin(), state.positions.end());
+        const std::vector<float> floatVelocities(state.velocities.begin(), state.velocities.end());
+
+        std::vector<Fixed16> fixed16(count);
+        std::vector<Fixed16> fixed16Velocities(count);
+        std::vector<Fixed32> fixed32(count);
+        std::vector<Fixed32> fixed32Velocities(count);
+        std::vector<Half> halves(count);
+        std::vector<Half> halfVelocities(count);
+        std::vector<BFloat16> bfloats(count);
+        std::vector<BFloat16> bfloatVelocities(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            fixed16[i] = Fixed16::FromFloat(state.positions[i] / 100.0);
+            fixed16Velocities[i] = Fixed16::FromFloat(state.velocities[i] / 100.0);
+            fixed32[i] = Fixed32::FromFloat(state.positions[i]);
+            fixed32Velocities[i] = Fixed32::FromFloat(state.velocities[i]);
+            halves[i] = Half::FromFloat(static_cast<float>(state.positions[i] / 100.0));
+            halfVelocities[i] = Half::FromFloat(static_cast<float>(state.velocities[i] / 100.0));
+            bfloats[i] = BFloat16::FromFloat(floats[i]);
+            bfloatVelocities[i] = BFloat16::FromFloat(floatVelocities[i]);
+        }
+
+        std::cout << "Kernels: " << GetNumericKernelPath() << std::endl;
+        std::cout << "Integrating " << count << " positions, millions of values per second:" << std::endl;
+        const auto report = [](const char* label, double valuesPerSecond)
+        {
+            std::cout << "  " << label << ": " << valuesPerSecond / 1e6 << std::endl;
+        };
+
+        report("double", ValuesPerSecond(count, repeats, [&]
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                doubles[i] += state.velocities[i] * (1.0 / 60.0);
+            }
+        }));
+        report("float", ValuesPerSecond(count, repeats, [&]
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                floats[i] += floatVelocities[i] * deltaSeconds;
+            }
+        }));
+
+        const auto fixedDelta = Fixed16::FromFloat(deltaSeconds);
+        auto fixed16Scalar = fixed16;
+        report("Fixed16, one at a time", ValuesPerSecond(count, repeats, [&] { IntegrateScalar(fixed16Scalar.data(), fixed16Velocities.data(), fixedDelta, count); }));
+        report("Fixed16, Integrate", ValuesPerSecond(count, repeats, [&] { Integrate(fixed16.data(), fixed16Velocities.data(), fixedDelta, count); }));
+
+        const auto fixed32Delta = Fixed32::FromFloat(deltaSeconds);
+        report("Fixed32, one at a time", ValuesPerSecond(count, repeats, [&]
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                fixed32[i] += fixed32Velocities[i] * fixed32Delta;
+            }
+        }));
+
+        auto halvesScalar = halves;
+        report("Half, one at a time", ValuesPerSecond(count, repeats, [&] { IntegrateScalar(halvesScalar.data(), halfVelocities.data(), deltaSeconds, count); }));
+        report("Half, Integrate", ValuesPerSecond(count, repeats, [&] { Integrate(halves.data(), halfVelocities.data(), deltaSeconds, count); }));
+
+        auto bfloatsScalar = bfloats;
+        report("BFloat16, one at a time", ValuesPerSecond(count, repeats, [&] { IntegrateScalar(bfloatsScalar.data(), bfloatVelocities.data(), deltaSeconds, count); }));
+        report("BFloat16, Integrate", ValuesPerSecond(count, repeats, [&] { Integrate(bfloats.data(), bfloatVelocities.data(), deltaSeconds, count); }));
+
+        // Both ran the same frames, with SIMD and without
+        if (HasSimdNumericKernels())
+        {
+            const auto identical = fixed16 == fixed16Scalar && halves == halvesScalar && bfloats == bfloatsScalar;
+            std::cout << GetNumericKernelPath() << " and one at a time bit-identical: " << (identical ? "yes" : "NO") << std::endl;
+        }
+        else
+        {
+            std::cout << "No SIMD on this machine, both columns ran the same code" << std::endl;
+        }
+
+        std::cout << "Converting " << count << " floats, millions of values per second:" << std::endl;
+        report("float to Half, one at a time", ValuesPerSecond(count, repeats, [&]
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                halvesScalar[i] = Half::FromFloat(floats[i]);
+            }
+        }));
+        report("float to Half, ConvertToHalf", ValuesPerSecond(count, repeats, [&] { ConvertToHalf(floats.data(), halves.data(), count); }));
+        report("Half to float, ConvertFromHalf", ValuesPerSecond(count, repeats, [&] { ConvertFromHalf(halves.data(), floats.data(), count); }));
+        report("float to BFloat16, one at a time", ValuesPerSecond(count, repeats, [&]
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                bfloatsScalar[i] = BFloat16::FromFloat(floats[i]);
+            }
+        }));
+        report("float to BFloat16, ConvertToBFloat16", ValuesPerSecond(count, repeats, [&] { ConvertToBFloat16(floats.data(), bfloats.data(), count); }));
+        report("float to Fixed16, one at a time", ValuesPerSecond(count, repeats, [&]
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                fixed16Scalar[i] = Fixed16::FromFloat(floats[i]);
+            }
+        }));
+        report("float to Fixed16, ConvertToFixed16", ValuesPerSecond(count, repeats, [&] { ConvertToFixed16(floats.data(), fixed16.data(), count); }));
+
+        sink = sink + static_cast<std::size_t>(doubles[0] + floats[0]) + static_cast<std::size_t>(fixed32[0].GetRaw()) + halves[0].bits + bfloats[0].bits;
+    }
+
+    void NumericsBenchmark()
+    {
+        std::cout << "== Fixed-point and 16 bit numbers ==" << std::endl;
+        NumericAccuracy();
+        NumericThroughput();
+    }
+
+    struct Benchmark
+    {
+        const char* name;
+        void (*run)();
+
+        // Benchmarks that take very long or need lots of memory only run when their exact name is given
+        bool runByDefault;
+    };
+
+    const Benchmark benchmarks[] = {
+        { "coroutines", CoroutineBenchmark, true },
+        { "allocations", AllocationTrackerBenchmark, true },
+        { "strings", StringBenchmark, true },
+        { "hashmap", HashMapBenchmark, true },
+        { "hashmap-100m", HashMapLargeBenchmark, false },
+        { "inputqueue", InputQueueBenchmark, true },
+        { "replication", ReplicationBenchmark, true },
+        { "significance", SignificanceBenchmark, true },
+        { "blendspace", BlendSpaceBenchmark, true },
+        { "pathfinding", PathfindingBenchmark, true },
+        { "uassetscan", PackageScanBenchmark, true },
+        { "uassetscan-100k", PackageScanLargeBenchmark, false },
+        { "arrays", ArrayAlgorithmsBenchmark, true },
+        { "sharedstate", SharedStateBenchmark, true },
+        { "dummyarchive", DummyArchiveBenchmark, true },
+        { "dummyarchive-200m", DummyArchiveLargeBenchmark, false },
+        { "numerics", NumericsBenchmark, true },
+    };
+}
+
+void RunBenchmarks(const std::string& filter)
+{
+    for (const auto& benchmark : benchmarks)
+    {
+        const auto selected = benchmark.runByDefault
+            ? filter.empty() || std::string(benchmark.name).find(filter) != std::string::npos
+            : filter == benchmark.name;
+
+        if (selected)
+        {
+            benchmark.run();
+        }
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+/*
+ * Benchmarks for the performance-related parts of the project
+ *
+ * Run with "CppForDummies bench" to run all of them, or "CppForDummies bench <name>" to run the ones whose name contains <name>
+ * Build in Release, Debug numbers are meaningless
+ */
+
+void RunBenchmarks(const std::string& filter);
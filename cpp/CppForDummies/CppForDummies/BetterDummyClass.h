@@ -2,7 +2,8 @@
 
 #include "MyDummyClass.h"
 
-class BetterDummyClass : MyDummyClass
+// Public inheritance, so a BetterDummyClass can be used wherever a MyDummyClass is expected (like a MyDummyClass& parameter)
+class BetterDummyClass : public MyDummyClass
 {
 public:
 	void SetPrivateNum(int newNum) override;
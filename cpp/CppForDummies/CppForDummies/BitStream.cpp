@@ -0,0 +1,84 @@
+#include "BitStream.h"
+
+/*
+ * Bits are collected in a 64-bit 'scratch' value and moved to the byte array 32 at a time.
+ * The first bit written ends up in the lowest bit of the first byte.
+ */
+
+void BitWriter::WriteBits(std::uint32_t value, int count)
+{
+    const auto mask = count == 32 ? 0xFFFFFFFFull : (1ull << count) - 1;
+    scratch |= (static_cast<std::uint64_t>(value) & mask) << scratchBits;
+    scratchBits += count;
+    bitCount += count;
+
+    if (scratchBits >= 32)
+    {
+        const auto size = bytes.size();
+        bytes.resize(size + 4);
+        for (auto i = 0; i < 4; i++)
+        {
+            bytes[size + i] = static_cast<std::uint8_t>(scratch >> (i * 8));
+        }
+        scratch >>= 32;
+        scratchBits -= 32;
+    }
+}
+
+void BitWriter::WriteSigned(std::int32_t value, int count)
+{
+    WriteBits(static_cast<std::uint32_t>(value), count);
+}
+
+const std::vector<std::uint8_t>& BitWriter::Finish()
+{
+    while (scratchBits > 0)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(scratch));
+        scratch >>= 8;
+        scratchBits -= 8;
+    }
+
+    // The padding bits count as written, so writing more afterwards starts on a fresh byte
+    bitCount = bytes.size() * 8;
+    scratchBits = 0;
+    return bytes;
+}
+
+void BitWriter::Reset()
+{
+    bytes.clear();
+    scratch = 0;
+    scratchBits = 0;
+    bitCount = 0;
+}
+
+std::uint32_t BitReader::ReadBits(int count)
+{
+    while (scratchBits < count)
+    {
+        if (bytePosition >= size)
+        {
+            overflowed = true;
+            return 0;
+        }
+
+        scratch |= static_cast<std::uint64_t>(data[bytePosition++]) << scratchBits;
+        scratchBits += 8;
+    }
+
+    const auto mask = count == 32 ? 0xFFFFFFFFull : (1ull << count) - 1;
+    const auto value = static_cast<std::uint32_t>(scratch & mask);
+    scratch >>= count;
+    scratchBits -= count;
+    return value;
+}
+
+std::int32_t BitReader::ReadSigned(int count)
+{
+    const auto value = ReadBits(count);
+
+    // Copy the sign bit into all the bits above it
+    const auto shift = 32 - count;
+    return static_cast<std::int32_t>(value << shift) >> shift;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ * BitWriter / BitReader - reading and writing values that don't fill whole bytes
+ *
+ * A bool only needs 1 bit and a number between 0 and 100 only needs 7, but the smallest thing a normal
+ * variable can be is 1 byte (8 bits). When sending data over the network every bit counts, so these
+ * pack values right next to each other, bit by bit.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BitWriter
+{
+public:
+	// Writes the lowest 'count' bits of the value, count must be between 1 and 32
+	void WriteBits(std::uint32_t value, int count);
+	void WriteBool(bool value) { WriteBits(value ? 1u : 0u, 1); }
+
+	// Writes a signed value that fits into 'count' bits (two's complement)
+	void WriteSigned(std::int32_t value, int count);
+
+	std::size_t GetBitCount() const { return bitCount; }
+
+	// Flushes the last partial byte and returns all bytes written so far
+	const std::vector<std::uint8_t>& Finish();
+
+	void Reset();
+
+private:
+	std::vector<std::uint8_t> bytes;
+	std::uint64_t scratch = 0;
+	int scratchBits = 0;
+	std::size_t bitCount = 0;
+};
+
+class BitReader
+{
+public:
+	BitReader(const std::uint8_t* data, std::size_t size) : data(data), size(size) {}
+
+	// Reading past the end returns zeroes and marks the reader as overflowed
+	std::uint32_t ReadBits(int count);
+	bool ReadBool() { return ReadBits(1) != 0; }
+	std::int32_t ReadSigned(int count);
+
+	bool IsOverflowed() const { return overflowed; }
+
+private:
+	const std::uint8_t* data;
+	std::size_t size;
+	std::size_t bytePosition = 0;
+	std::uint64_t scratch = 0;
+	int scratchBits = 0;
+	bool overflowed = false;
+};
@@ -0,0 +1,582 @@
+#include "BlendSpace.h"
+#include "Coroutines.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BLEND_SPACE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLEND_SPACE_SSE2 1
+#endif
+
+/*
+ * Pose
+ */
+
+Pose::Pose(int boneCount)
+    : boneCount(boneCount), stride((boneCount + BonePadding - 1) / BonePadding * BonePadding), data(static_cast<std::size_t>(stride) * ChannelCount, 0.0f)
+{
+    // Every bone starts out as the identity transform, including the padding, so normalizing padding rotations never divides by zero
+    std::fill_n(GetChannel(RotationW), stride, 1.0f);
+    std::fill_n(GetChannel(ScaleX), stride * 3, 1.0f);
+}
+
+void Pose::SetBone(int bone, const BoneTransform& transform)
+{
+    for (auto i = 0; i < 4; i++)
+    {
+        GetChannel(RotationX + i)[bone] = transform.rotation[i];
+    }
+    for (auto i = 0; i < 3; i++)
+    {
+        GetChannel(TranslationX + i)[bone] = transform.translation[i];
+        GetChannel(ScaleX + i)[bone] = transform.scale[i];
+    }
+}
+
+BoneTransform Pose::GetBone(int bone) const
+{
+    BoneTransform transform;
+    for (auto i = 0; i < 4; i++)
+    {
+        transform.rotation[i] = GetChannel(RotationX + i)[bone];
+    }
+    for (auto i = 0; i < 3; i++)
+    {
+        transform.translation[i] = GetChannel(TranslationX + i)[bone];
+        transform.scale[i] = GetChannel(ScaleX + i)[bone];
+    }
+    return transform;
+}
+
+/*
+ * Blending
+ */
+
+void BlendPosesScalar(const PoseSource* sources, int count, Pose& out)
+{
+    if (count <= 0 || count > BlendSpace2D::MaxSources)
+    {
+        return;
+    }
+
+    const auto stride = out.GetStride();
+    const auto& first = *sources[0].pose;
+
+    for (auto bone = 0; bone < stride; bone++)
+    {
+        float rotation[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (auto k = 0; k < count; k++)
+        {
+            const auto& pose = *sources[k].pose;
+
+            // q and -q are the same rotation, use whichever is closer to the first source or the blend takes the long way round
+            auto dot = 0.0f;
+            for (auto i = 0; i < 4; i++)
+            {
+                dot += pose.GetChannel(Pose::RotationX + i)[bone] * first.GetChannel(Pose::RotationX + i)[bone];
+            }
+            const auto weight = dot < 0.0f ? -sources[k].weight : sources[k].weight;
+
+            for (auto i = 0; i < 4; i++)
+            {
+                rotation[i] += pose.GetChannel(Pose::RotationX + i)[bone] * weight;
+            }
+        }
+
+        const auto inverseLength = 1.0f / std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+        for (auto i = 0; i < 4; i++)
+        {
+            out.GetChannel(Pose::RotationX + i)[bone] = rotation[i] * inverseLength;
+        }
+
+        for (auto channel = static_cast<int>(Pose::TranslationX); channel < Pose::ChannelCount; channel++)
+        {
+            auto value = 0.0f;
+            for (auto k = 0; k < count; k++)
+            {
+                value += sources[k].pose->GetChannel(channel)[bone] * sources[k].weight;
+            }
+            out.GetChannel(channel)[bone] = value;
+        }
+    }
+}
+
+#if defined(BLEND_SPACE_AVX) || defined(BLEND_SPACE_SSE2)
+
+namespace
+{
+    // The same handful of operations for both instruction sets, so the blend below is written once
+#if defined(BLEND_SPACE_AVX)
+    using Lanes = __m256;
+    constexpr int LaneCount = 8;
+
+    inline Lanes Load(const float* source) { return _mm256_loadu_ps(source); }
+    inline void Store(float* destination, Lanes value) { _mm256_storeu_ps(destination, value); }
+    inline Lanes Splat(float value) { return _mm256_set1_ps(value); }
+    inline Lanes Zero() { return _mm256_setzero_ps(); }
+    inline Lanes Add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+    inline Lanes Mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+    inline Lanes Div(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+    inline Lanes Sqrt(Lanes a) { return _mm256_sqrt_ps(a); }
+    inline Lanes And(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+    inline Lanes Xor(Lanes a, Lanes b) { return _mm256_xor_ps(a, b); }
+    inline Lanes LessThan(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+#else
+    using Lanes = __m128;
+    constexpr int LaneCount = 4;
+
+    inline Lanes Load(const float* source) { return _mm_loadu_ps(source); }
+    inline void Store(float* destination, Lanes value) { _mm_storeu_ps(destination, value); }
+    inline Lanes Splat(float value) { return _mm_set1_ps(value); }
+    inline Lanes Zero() { return _mm_setzero_ps(); }
+    inline Lanes Add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+    inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+    inline Lanes Div(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+    inline Lanes Sqrt(Lanes a) { return _mm_sqrt_ps(a); }
+    inline Lanes And(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+    inline Lanes Xor(Lanes a, Lanes b) { return _mm_xor_ps(a, b); }
+    inline Lanes LessThan(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+#endif
+
+    static_assert(Pose::BonePadding % LaneCount == 0, "Pose padding must be a multiple of the SIMD width");
+}
+
+void BlendPoses(const PoseSource* sources, int count, Pose& out)
+{
+    // 'rotations' below has room for MaxSources
+    if (count <= 0 || count > BlendSpace2D::MaxSources)
+    {
+        return;
+    }
+
+    const auto stride = out.GetStride();
+    const auto signBit = Splat(-0.0f);
+
+    const float* rotations[BlendSpace2D::MaxSources][4];
+    for (auto k = 0; k < count; k++)
+    {
+        for (auto i = 0; i < 4; i++)
+        {
+            rotations[k][i] = sources[k].pose->GetChannel(Pose::RotationX + i);
+        }
+    }
+
+    for (auto bone = 0; bone < stride; bone += LaneCount)
+    {
+        Lanes first[4];
+        for (auto i = 0; i < 4; i++)
+        {
+            first[i] = Load(rotations[0][i] + bone);
+        }
+
+        Lanes rotation[4] = { Zero(), Zero(), Zero(), Zero() };
+        for (auto k = 0; k < count; k++)
+        {
+            Lanes q[4];
+            for (auto i = 0; i < 4; i++)
+            {
+                q[i] = Load(rotations[k][i] + bone);
+            }
+
+            // Flip the weight's sign in the lanes where this rotation points away from the first one
+            const auto dot = Add(Add(Mul(q[0], first[0]), Mul(q[1], first[1])), Add(Mul(q[2], first[2]), Mul(q[3], first[3])));
+            const auto weight = Xor(Splat(sources[k].weight), And(LessThan(dot, Zero()), signBit));
+
+            for (auto i = 0; i < 4; i++)
+            {
+                rotation[i] = Add(rotation[i], Mul(q[i], weight));
+            }
+        }
+
+        const auto lengthSquared = Add(Add(Mul(rotation[0], rotation[0]), Mul(rotation[1], rotation[1])), Add(Mul(rotation[2], rotation[2]), Mul(rotation[3], rotation[3])));
+        const auto inverseLength = Div(Splat(1.0f), Sqrt(lengthSquared));
+        for (auto i = 0; i < 4; i++)
+        {
+            Store(out.GetChannel(Pose::RotationX + i) + bone, Mul(rotation[i], inverseLength));
+        }
+
+        for (auto channel = static_cast<int>(Pose::TranslationX); channel < Pose::ChannelCount; channel++)
+        {
+            auto value = Zero();
+            for (auto k = 0; k < count; k++)
+            {
+                value = Add(value, Mul(Load(sources[k].pose->GetChannel(channel) + bone), Splat(sources[k].weight)));
+            }
+            Store(out.GetChannel(channel) + bone, value);
+        }
+    }
+}
+
+#else
+
+void BlendPoses(const PoseSource* sources, int count, Pose& out)
+{
+    BlendPosesScalar(sources, count, out);
+}
+
+#endif
+
+/*
+ * BlendSpace2D
+ */
+
+namespace
+{
+    // Collects weighted samples, merging repeats, and keeps the biggest ones
+    class WeightAccumulator
+    {
+    public:
+        void Add(const BlendSampleWeights& weights, float scale)
+        {
+            for (auto i = 0; i < weights.count; i++)
+            {
+                Add(weights.samples[i], weights.weights[i] * scale);
+            }
+        }
+
+        void Add(int sample, float weight)
+        {
+            if (weight <= 0.0f)
+            {
+                return;
+            }
+
+            for (auto i = 0; i < count; i++)
+            {
+                if (samples[i] == sample)
+                {
+                    weights[i] += weight;
+                    return;
+                }
+            }
+
+            samples[count] = sample;
+            weights[count] = weight;
+            count++;
+        }
+
+        BlendSampleWeights Finish()
+        {
+            // Sort by weight, largest first, and drop whatever doesn't fit
+            for (auto i = 1; i < count; i++)
+            {
+                for (auto j = i; j > 0 && weights[j] > weights[j - 1]; j--)
+                {
+                    std::swap(weights[j], weights[j - 1]);
+                    std::swap(samples[j], samples[j - 1]);
+                }
+            }
+
+            BlendSampleWeights result;
+            result.count = std::min(count, BlendSampleWeights::MaxSamples);
+
+            auto total = 0.0f;
+            for (auto i = 0; i < result.count; i++)
+            {
+                total += weights[i];
+            }
+            for (auto i = 0; i < result.count; i++)
+            {
+                result.samples[i] = samples[i];
+                result.weights[i] = weights[i] / total;
+            }
+            return result;
+        }
+
+    private:
+        // Three grid points with up to 4 samples each
+        static constexpr int Capacity = BlendSampleWeights::MaxSamples * 3;
+
+        int count = 0;
+        int samples[Capacity] = {};
+        float weights[Capacity] = {};
+    };
+
+    BlendSampleWeights Lerp(const BlendSampleWeights& a, const BlendSampleWeights& b, float alpha)
+    {
+        WeightAccumulator accumulator;
+        accumulator.Add(a, 1.0f - alpha);
+        accumulator.Add(b, alpha);
+        return accumulator.Finish();
+    }
+
+    // 0 to 1 along the axis, the range must not be empty. A NaN input counts as the start, converting NaN to int is undefined.
+    float AxisFraction(const BlendParameter& parameter, float value)
+    {
+        const auto fraction = (value - parameter.min) / (parameter.max - parameter.min);
+        return fraction > 0.0f ? std::min(fraction, 1.0f) : 0.0f;
+    }
+
+    // Where a value falls on the grid: the cell, and how far into it (0 to 1)
+    void Locate(const BlendParameter& parameter, float value, int& cell, float& alpha)
+    {
+        // An axis without a range has nothing to divide by, everything is at its only point
+        if (parameter.gridDivisions == 0 || !(parameter.max > parameter.min))
+        {
+            cell = 0;
+            alpha = 0.0f;
+            return;
+        }
+
+        const auto position = AxisFraction(parameter, value) * parameter.gridDivisions;
+        cell = std::min(static_cast<int>(position), parameter.gridDivisions - 1);
+        alpha = position - cell;
+    }
+
+    int ClosestGridPoint(const BlendParameter& parameter, float value)
+    {
+        if (parameter.gridDivisions == 0 || !(parameter.max > parameter.min))
+        {
+            return 0;
+        }
+
+        const auto position = AxisFraction(parameter, value) * parameter.gridDivisions;
+        return static_cast<int>(std::lround(position));
+    }
+}
+
+BlendSpace2D::BlendSpace2D(BlendParameter x, BlendParameter y)
+    : x(x), y(y)
+{
+    this->x.gridDivisions = std::max(this->x.gridDivisions, 1);
+    this->y.gridDivisions = std::max(this->y.gridDivisions, 0);
+
+    // A Y axis without a range (min == max, or NaN) is a 1D blend space. X always keeps one cell, the helpers above
+    // put every sample and input at its first point.
+    if (!(this->y.max > this->y.min))
+    {
+        this->y.gridDivisions = 0;
+    }
+}
+
+bool BlendSpace2D::AddSample(const AnimationClip* clip, float sampleX, float sampleY)
+{
+    // Evaluate() samples every clip between two of its keys, there has to be at least one
+    if (clip == nullptr || clip->keys.empty())
+    {
+        return false;
+    }
+
+    samples.push_back({ clip, ClosestGridPoint(x, sampleX), ClosestGridPoint(y, sampleY) });
+    return true;
+}
+
+void BlendSpace2D::Build()
+{
+    const auto columns = x.gridDivisions + 1;
+    const auto rows = y.gridDivisions + 1;
+    grid.assign(static_cast<std::size_t>(columns) * rows, BlendSampleWeights());
+
+    // Grid points with a sample on them are just that sample
+    std::vector<bool> rowHasSamples(rows, false);
+    for (std::size_t i = 0; i < samples.size(); i++)
+    {
+        auto& point = grid[GetGridIndex(samples[i].gridX, samples[i].gridY)];
+        point.count = 1;
+        point.samples[0] = static_cast<int>(i);
+        point.weights[0] = 1.0f;
+        rowHasSamples[samples[i].gridY] = true;
+    }
+
+    // Empty points between samples on the same row mix the samples to their left and right, points past the end copy the last one
+    for (auto row = 0; row < rows; row++)
+    {
+        if (!rowHasSamples[row])
+        {
+            continue;
+        }
+
+        std::vector<int> filled;
+        for (auto column = 0; column < columns; column++)
+        {
+            if (grid[GetGridIndex(column, row)].count > 0)
+            {
+                filled.push_back(column);
+            }
+        }
+
+        for (auto column = 0; column < columns; column++)
+        {
+            auto& point = grid[GetGridIndex(column, row)];
+            if (point.count > 0)
+            {
+                continue;
+            }
+
+            const auto right = std::lower_bound(filled.begin(), filled.end(), column);
+            if (right == filled.begin())
+            {
+                point = grid[GetGridIndex(*right, row)];
+            }
+            else if (right == filled.end())
+            {
+                point = grid[GetGridIndex(filled.back(), row)];
+            }
+            else
+            {
+                const auto left = *(right - 1);
+                point = Lerp(grid[GetGridIndex(left, row)], grid[GetGridIndex(*right, row)], static_cast<float>(column - left) / (*right - left));
+            }
+        }
+    }
+
+    // Rows without samples mix the rows below and above them the same way
+    std::vector<int> filledRows;
+    for (auto row = 0; row < rows; row++)
+    {
+        if (rowHasSamples[row])
+        {
+            filledRows.push_back(row);
+        }
+    }
+
+    if (filledRows.empty())
+    {
+        return;
+    }
+
+    for (auto row = 0; row < rows; row++)
+    {
+        if (rowHasSamples[row])
+        {
+            continue;
+        }
+
+        const auto above = std::lower_bound(filledRows.begin(), filledRows.end(), row);
+        for (auto column = 0; column < columns; column++)
+        {
+            auto& point = grid[GetGridIndex(column, row)];
+            if (above == filledRows.begin())
+            {
+                point = grid[GetGridIndex(column, *above)];
+            }
+            else if (above == filledRows.end())
+            {
+                point = grid[GetGridIndex(column, filledRows.back())];
+            }
+            else
+            {
+                const auto below = *(above - 1);
+                point = Lerp(grid[GetGridIndex(column, below)], grid[GetGridIndex(column, *above)], static_cast<float>(row - below) / (*above - below));
+            }
+        }
+    }
+}
+
+BlendSampleWeights BlendSpace2D::GetWeights(float inputX, float inputY) const
+{
+    int cellX, cellY;
+    float alphaX, alphaY;
+    Locate(x, inputX, cellX, alphaX);
+    Locate(y, inputY, cellY, alphaY);
+
+    WeightAccumulator accumulator;
+
+    if (y.gridDivisions == 0)
+    {
+        accumulator.Add(grid[GetGridIndex(cellX, 0)], 1.0f - alphaX);
+        accumulator.Add(grid[GetGridIndex(cellX + 1, 0)], alphaX);
+        return accumulator.Finish();
+    }
+
+    /*
+     * Every cell is cut into two triangles along its diagonal from (0, 0) to (1, 1)
+     *
+     *      (0,1) ----- (1,1)
+     *        |       /   |
+     *        |     /     |
+     *        |   /       |
+     *      (0,0) ----- (1,0)
+     */
+    const auto& corner00 = grid[GetGridIndex(cellX, cellY)];
+    const auto& corner11 = grid[GetGridIndex(cellX + 1, cellY + 1)];
+
+    if (alphaX >= alphaY)
+    {
+        accumulator.Add(corner00, 1.0f - alphaX);
+        accumulator.Add(grid[GetGridIndex(cellX + 1, cellY)], alphaX - alphaY);
+        accumulator.Add(corner11, alphaY);
+    }
+    else
+    {
+        accumulator.Add(corner00, 1.0f - alphaY);
+        accumulator.Add(grid[GetGridIndex(cellX, cellY + 1)], alphaY - alphaX);
+        accumulator.Add(corner11, alphaX);
+    }
+
+    return accumulator.Finish();
+}
+
+void BlendSpace2D::Evaluate(const BlendSpaceInput& input, Pose& out) const
+{
+    const auto weights = GetWeights(input.x, input.y);
+    const auto phase = input.phase - std::floor(input.phase);
+
+    PoseSource sources[MaxSources];
+    auto count = 0;
+
+    // Every sample is sampled at the same phase, between the two keys around it
+    for (auto i = 0; i < weights.count; i++)
+    {
+        const auto& keys = samples[weights.samples[i]].clip->keys;
+        const auto keyCount = static_cast<int>(keys.size());
+        const auto position = phase * keyCount;
+        const auto key = std::min(static_cast<int>(position), keyCount - 1);
+        const auto alpha = position - key;
+
+        sources[count++] = { &keys[key], weights.weights[i] * (1.0f - alpha) };
+        if (alpha > 0.0f)
+        {
+            sources[count++] = { &keys[(key + 1) % keyCount], weights.weights[i] * alpha };
+        }
+    }
+
+    if (count == 0)
+    {
+        out = Pose(out.GetBoneCount());
+        return;
+    }
+
+    BlendPoses(sources, count, out);
+}
+
+/*
+ * Many characters at once
+ */
+
+namespace
+{
+    Task<void> EvaluateRange(const BlendSpace2D& blendSpace, const BlendSpaceInput* inputs, Pose* outputs, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            blendSpace.Evaluate(inputs[i], outputs[i]);
+        }
+        co_return;
+    }
+}
+
+void EvaluateBlendSpaces(const BlendSpace2D& blendSpace, const BlendSpaceInput* inputs, Pose* outputs, std::size_t count, ThreadPoolExecutor& pool)
+{
+    const auto threadCount = pool.GetThreadCount();
+    if (threadCount <= 1)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            blendSpace.Evaluate(inputs[i], outputs[i]);
+        }
+        return;
+    }
+
+    // A few chunks per thread, so a thread that got descheduled doesn't hold everyone up
+    const auto chunks = static_cast<std::size_t>(threadCount) * 4;
+    const auto chunkSize = (count + chunks - 1) / chunks;
+    for (std::size_t start = 0; start < count; start += chunkSize)
+    {
+        Spawn(pool, EvaluateRange(blendSpace, inputs + start, outputs + start, std::min(chunkSize, count - start)));
+    }
+    pool.Run();
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+/*
+ * BlendSpace2D - picking and mixing animations from two input values, without the engine
+ *
+ * ThirdPerson_AnimBP plays ThirdPerson_IdleRun_2D, which blends ThirdPersonIdle, ThirdPersonWalk and ThirdPersonRun
+ * depending on how fast the character moves (the speed MoveForward/MoveRight produce).
+ * A blend space places every animation (a sample) at a point on a grid, for example Direction on X and Speed on Y.
+ *
+ * Build() works out, for every grid point, which samples it is made of. The grid is cut into triangles
+ * (two per cell), and evaluating finds the triangle the input falls into and mixes its three corners
+ * by barycentric weights - how close the input is to each corner.
+ *
+ * A pose is every bone's rotation, translation and scale. Poses are stored as structure of arrays (SoA):
+ * all bones' rotation X next to each other, then all rotation Y and so on. That way SIMD instructions
+ * (SSE2 or AVX) blend 4 or 8 bones at once.
+ *
+ *      BlendSpace2D blendSpace({ -180.0f, 180.0f, 4 }, { 0.0f, 600.0f, 4 });
+ *      blendSpace.AddSample(&idle, 0.0f, 0.0f);
+ *      blendSpace.AddSample(&run, 0.0f, 600.0f);
+ *      blendSpace.Build();
+ *
+ *      Pose pose(68);
+ *      blendSpace.Evaluate({ direction, speed, phase }, pose);
+ */
+
+#include <cstddef>
+#include <vector>
+
+class ThreadPoolExecutor;
+
+struct BoneTransform
+{
+	// Quaternion x, y, z, w
+	float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float translation[3] = { 0.0f, 0.0f, 0.0f };
+	float scale[3] = { 1.0f, 1.0f, 1.0f };
+};
+
+class Pose
+{
+public:
+	enum Channel
+	{
+		RotationX, RotationY, RotationZ, RotationW,
+		TranslationX, TranslationY, TranslationZ,
+		ScaleX, ScaleY, ScaleZ,
+		ChannelCount
+	};
+
+	// Every channel is padded to a multiple of this many bones, so SIMD code never needs a leftover loop
+	static constexpr int BonePadding = 8;
+
+	Pose() = default;
+	explicit Pose(int boneCount);
+
+	int GetBoneCount() const { return boneCount; }
+	int GetStride() const { return stride; }
+
+	float* GetChannel(int channel) { return data.data() + static_cast<std::size_t>(channel) * stride; }
+	const float* GetChannel(int channel) const { return data.data() + static_cast<std::size_t>(channel) * stride; }
+
+	void SetBone(int bone, const BoneTransform& transform);
+	BoneTransform GetBone(int bone) const;
+
+private:
+	int boneCount = 0;
+	int stride = 0;
+	std::vector<float> data;
+};
+
+// A looping animation, its keys are spread evenly over one loop
+struct AnimationClip
+{
+	std::vector<Pose> keys;
+};
+
+struct PoseSource
+{
+	const Pose* pose;
+	float weight;
+};
+
+/*
+ * out = the weighted sum of the sources, all with the same bone count
+ * 'count' is 1 to BlendSpace2D::MaxSources, anything else leaves 'out' as it is. Weights should add up to 1. Rotations are flipped onto the same side as the first source and normalized (nlerp).
+ */
+void BlendPoses(const PoseSource* sources, int count, Pose& out);
+
+// The same without SIMD, to compare against
+void BlendPosesScalar(const PoseSource* sources, int count, Pose& out);
+
+struct BlendParameter
+{
+	float min;
+	float max;
+
+	// 0 divisions on Y makes a 1D blend space, like a BlendSpace1D. So does a Y axis with max <= min.
+	int gridDivisions;
+};
+
+struct BlendSampleWeights
+{
+	static constexpr int MaxSamples = 4;
+
+	int count = 0;
+	int samples[MaxSamples] = {};
+	float weights[MaxSamples] = {};
+};
+
+struct BlendSpaceInput
+{
+	float x;
+	float y;
+
+	// Where in the loop all animations are, from 0 to 1. Samples are synced by this, so feet stay in step.
+	float phase;
+};
+
+class BlendSpace2D
+{
+public:
+	// At most 4 samples per key, 2 keys per sample
+	static constexpr int MaxSources = BlendSampleWeights::MaxSamples * 2;
+
+	BlendSpace2D(BlendParameter x, BlendParameter y);
+
+	// Samples are moved to the closest grid point. The clip must stay alive as long as the blend space.
+	// Returns false, and adds nothing, if the clip has no keys.
+	bool AddSample(const AnimationClip* clip, float x, float y);
+
+	// Call once after adding all samples
+	void Build();
+
+	// Which samples to mix, and how much of each, for this input
+	BlendSampleWeights GetWeights(float x, float y) const;
+
+	// 'out' must have the skeleton's bone count
+	void Evaluate(const BlendSpaceInput& input, Pose& out) const;
+
+private:
+	struct Sample
+	{
+		const AnimationClip* clip;
+		int gridX;
+		int gridY;
+	};
+
+	int GetGridIndex(int x, int y) const { return y * (this->x.gridDivisions + 1) + x; }
+
+	BlendParameter x;
+	BlendParameter y;
+	std::vector<Sample> samples;
+	std::vector<BlendSampleWeights> grid;
+};
+
+// Evaluates many characters, split over the pool's threads. Keep the pool around from frame to frame.
+void EvaluateBlendSpaces(const BlendSpace2D& blendSpace, const BlendSpaceInput* inputs, Pose* outputs, std::size_t count, ThreadPoolExecutor& pool);
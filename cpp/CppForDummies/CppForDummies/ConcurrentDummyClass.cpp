@@ -0,0 +1,24 @@
+#include "ConcurrentDummyClass.h"
+
+ConcurrentDummyClass::ConcurrentDummyClass(MyDummyClass& object)
+    : object(object), snapshot({ object.num, object.GetPrivateNum() })
+{
+}
+
+void ConcurrentDummyClass::SetNum(int newNum)
+{
+    object.num = newNum;
+    Publish();
+}
+
+void ConcurrentDummyClass::SetPrivateNum(int newNum)
+{
+    object.SetPrivateNum(newNum);
+    Publish();
+}
+
+void ConcurrentDummyClass::Publish()
+{
+    // Read back from the object, an override may have changed or ignored the value it was given
+    snapshot.Store({ object.num, object.GetPrivateNum() });
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+/*
+ * ConcurrentDummyClass - sharing a MyDummyClass between one thread that changes it and many threads that read it
+ *
+ * MyDummyClass itself isn't safe to use from several threads: a thread reading num while another writes it is a data race.
+ * ConcurrentDummyClass wraps an existing object. The writer changes the object through it, and after every change
+ * num and privateNum are published as a snapshot (see SeqLock.h) that readers can copy without taking a lock.
+ *
+ * Changes still go through the object's own functions, so a BetterDummyClass still runs its SetPrivateNum override:
+ *
+ *      BetterDummyClass better;
+ *      ConcurrentDummyClass shared(better);
+ *
+ *      // The one writer thread
+ *      shared.SetPrivateNum(11);
+ *      shared.Update([](MyDummyClass& object) { object.num = 1; object.SetPrivateNum(2); });
+ *
+ *      // Any other thread, num and privateNum always come from the same update
+ *      auto snapshot = shared.GetSnapshot();
+ *
+ * Once wrapped, only the writer thread may touch the object directly, and it must outlive the wrapper.
+ */
+
+#include "MyDummyClass.h"
+#include "SeqLock.h"
+#include <cstdint>
+
+struct DummySnapshot
+{
+	int num = 0;
+	int privateNum = 0;
+};
+
+class ConcurrentDummyClass
+{
+public:
+	explicit ConcurrentDummyClass(MyDummyClass& object);
+
+	// Readers, any thread
+	DummySnapshot GetSnapshot() const { return snapshot.Load(); }
+	int GetNum() const { return snapshot.Load().num; }
+	int GetPrivateNum() const { return snapshot.Load().privateNum; }
+
+	// Goes up by one with every change, readers can compare it to see whether they missed anything
+	std::uint64_t GetVersion() const { return snapshot.GetVersion(); }
+
+	// Writer, only one thread at a time
+	void SetNum(int newNum);
+
+	// Calls the object's (virtual) SetPrivateNum
+	void SetPrivateNum(int newNum);
+
+	// Several changes that readers should only ever see together, 'change' gets the object
+	template <typename Function>
+	void Update(Function&& change)
+	{
+		change(object);
+		Publish();
+	}
+
+private:
+	void Publish();
+
+	MyDummyClass& object;
+	SeqLock<DummySnapshot> snapshot;
+};
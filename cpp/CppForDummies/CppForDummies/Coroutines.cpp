@@ -0,0 +1,355 @@
+#include "Coroutines.h"
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+ * Executor
+ *
+ * All executors share the same queues, the only difference is how many threads call WorkerLoop()
+ */
+
+void Executor::Schedule(std::coroutine_handle<> handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(handle);
+    }
+    wakeUp.notify_one();
+}
+
+void Executor::ScheduleAt(std::chrono::steady_clock::time_point when, std::coroutine_handle<> handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        timers.push({ when, timerSequence++, handle });
+    }
+
+    // A sleeping worker might be waiting for a later timer, so wake one up to re-check
+    wakeUp.notify_one();
+}
+
+void Executor::Hold()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    holds++;
+}
+
+void Executor::Release()
+{
+    // Notify while still holding the lock, once it's released Run() may return and the executor may be gone
+    std::lock_guard<std::mutex> lock(mutex);
+    holds--;
+    wakeUp.notify_all();
+}
+
+void Executor::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        // Move every timer that is due over to the ready queue
+        auto now = std::chrono::steady_clock::now();
+        while (!timers.empty() && timers.top().when <= now)
+        {
+            ready.push_back(timers.top().handle);
+            timers.pop();
+        }
+
+        if (!ready.empty())
+        {
+            auto handle = ready.front();
+            ready.pop_front();
+            running++;
+
+            // Never hold the lock while running user code, the coroutine might schedule more work
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+
+            running--;
+            continue;
+        }
+
+        // Nothing is ready, nothing is running and nothing will ever become ready, we're done
+        if (running == 0 && timers.empty() && holds == 0)
+        {
+            wakeUp.notify_all();
+            return;
+        }
+
+        if (!timers.empty())
+        {
+            wakeUp.wait_until(lock, timers.top().when);
+        }
+        else
+        {
+            wakeUp.wait(lock);
+        }
+    }
+}
+
+void SingleThreadExecutor::Run()
+{
+    WorkerLoop();
+}
+
+ThreadPoolExecutor::ThreadPoolExecutor(int threadCount) : threadCount(threadCount > 0 ? threadCount : 1)
+{
+    workers.reserve(this->threadCount);
+    for (auto i = 0; i < this->threadCount; i++)
+    {
+        workers.emplace_back([this] { WorkerThread(); });
+    }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(runMutex);
+        stopping = true;
+        runChanged.notify_all();
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPoolExecutor::Run()
+{
+    std::unique_lock<std::mutex> lock(runMutex);
+    finished = 0;
+    generation++;
+    runChanged.notify_all();
+    runChanged.wait(lock, [this] { return finished == threadCount; });
+}
+
+void ThreadPoolExecutor::WorkerThread()
+{
+    // Starts at 0 rather than reading 'generation', Run() may have been called before this thread got going
+    std::unique_lock<std::mutex> lock(runMutex);
+    unsigned long long seen = 0;
+
+    while (true)
+    {
+        runChanged.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping)
+        {
+            return;
+        }
+        seen = generation;
+
+        lock.unlock();
+        WorkerLoop();
+        lock.lock();
+
+        finished++;
+        runChanged.notify_all();
+    }
+}
+
+/*
+ * Spawn
+ *
+ * A detached coroutine starts right away, hops onto the executor and then runs the task to completion.
+ * Nobody awaits it, so it cleans up after itself when it finishes.
+ */
+
+namespace
+{
+    struct DetachedTask
+    {
+        struct promise_type
+        {
+            DetachedTask get_return_object() { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    DetachedTask RunDetached(Executor& executor, Task<void> task)
+    {
+        co_await ScheduleOn{ executor };
+        co_await std::move(task);
+    }
+}
+
+void Spawn(Executor& executor, Task<void> task)
+{
+    RunDetached(executor, std::move(task));
+}
+
+/*
+ * ReadAsync
+ */
+
+#ifdef __linux__
+
+namespace
+{
+    /*
+     * The reactor owns one epoll instance and a thread that waits on it.
+     * When a file descriptor becomes readable, the waiting coroutine is handed back to its executor.
+     */
+    class Reactor
+    {
+    public:
+        static Reactor& Get()
+        {
+            static Reactor reactor;
+            return reactor;
+        }
+
+        // Returns 0, or the errno of epoll_ctl: EPERM for descriptors that are always readable (regular files),
+        // EEXIST if another coroutine is already waiting on the same one
+        int Watch(int fd, Executor& executor, std::coroutine_handle<> handle)
+        {
+            auto waiter = new Waiter{ &executor, handle, fd };
+
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLONESHOT;
+            event.data.ptr = waiter;
+
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+            {
+                const auto error = errno;
+                delete waiter;
+                return error;
+            }
+
+            return 0;
+        }
+
+    private:
+        struct Waiter
+        {
+            Executor* executor;
+            std::coroutine_handle<> handle;
+            int fd;
+        };
+
+        Reactor()
+        {
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            stopFd = eventfd(0, EFD_CLOEXEC);
+
+            // The stop event has no waiter attached, that's how the thread recognizes it
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.ptr = nullptr;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event);
+
+            thread = std::thread([this] { Loop(); });
+        }
+
+        ~Reactor()
+        {
+            unsigned long long one = 1;
+            [[maybe_unused]] auto written = write(stopFd, &one, sizeof(one));
+            thread.join();
+
+            close(stopFd);
+            close(epollFd);
+        }
+
+        void Loop()
+        {
+            epoll_event events[64];
+
+            while (true)
+            {
+                auto count = epoll_wait(epollFd, events, 64, -1);
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                for (auto i = 0; i < count; i++)
+                {
+                    auto waiter = static_cast<Waiter*>(events[i].data.ptr);
+                    if (waiter == nullptr)
+                    {
+                        return;
+                    }
+
+                    // Remove the descriptor so the next ReadAsync on it can add it again
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, waiter->fd, nullptr);
+
+                    waiter->executor->Schedule(waiter->handle);
+                    waiter->executor->Release();
+                    delete waiter;
+                }
+            }
+        }
+
+        int epollFd;
+        int stopFd;
+        std::thread thread;
+    };
+}
+
+void ReadAsync::await_suspend(std::coroutine_handle<> handle)
+{
+    executor.Hold();
+
+    const auto result = Reactor::Get().Watch(fd, executor, handle);
+    if (result != 0)
+    {
+        // A regular file never blocks, so reading it right away is fine. Anything else, like a second waiter on the
+        // same pipe, could block the executor's thread forever (maybe the writer is a task on that same thread).
+        error = result == EPERM ? 0 : result;
+        executor.Schedule(handle);
+        executor.Release();
+    }
+}
+
+long long ReadAsync::await_resume()
+{
+    if (error != 0)
+    {
+        errno = error;
+        return -1;
+    }
+
+    while (true)
+    {
+        auto result = read(fd, buffer, size);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        return result;
+    }
+}
+
+#else
+
+void ReadAsync::await_suspend(std::coroutine_handle<> handle)
+{
+    executor.Schedule(handle);
+}
+
+long long ReadAsync::await_resume()
+{
+#ifdef _WIN32
+    return _read(fd, buffer, static_cast<unsigned int>(size));
+#else
+    return read(fd, buffer, size);
+#endif
+}
+
+#endif
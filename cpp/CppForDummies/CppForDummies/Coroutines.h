@@ -0,0 +1,283 @@
+#pragma once
+
+/*
+ * A small coroutine runtime
+ *
+ * A coroutine is a function that can pause itself (co_await) and be resumed later, right where it left off.
+ * While it is paused, the thread is free to run other coroutines, so nothing is blocked waiting.
+ *
+ * Task<T> is a coroutine that eventually produces a T (use co_return to hand back the value)
+ * Executors decide which thread resumes a paused coroutine and when
+ *      SingleThreadExecutor runs everything on the thread that calls Run()
+ *      ThreadPoolExecutor runs everything on N worker threads
+ *
+ * Needs C++20
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Executor
+{
+public:
+	virtual ~Executor() = default;
+
+	// Resume the coroutine as soon as a worker is free
+	void Schedule(std::coroutine_handle<> handle);
+
+	// Resume the coroutine once the time point has passed
+	void ScheduleAt(std::chrono::steady_clock::time_point when, std::coroutine_handle<> handle);
+
+	// Hold() keeps Run() from returning while a coroutine waits on something outside the executor (like a pipe)
+	// Release() must be called once the coroutine has been scheduled again
+	void Hold();
+	void Release();
+
+protected:
+	// Runs coroutines until there's nothing left to do. Every worker thread calls this.
+	void WorkerLoop();
+
+private:
+	struct Timer
+	{
+		std::chrono::steady_clock::time_point when;
+		unsigned long long sequence;
+		std::coroutine_handle<> handle;
+
+		// priority_queue puts the largest element on top, so the earliest timer has to compare as the largest
+		bool operator<(const Timer& other) const
+		{
+			return when != other.when ? when > other.when : sequence > other.sequence;
+		}
+	};
+
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::deque<std::coroutine_handle<>> ready;
+	std::priority_queue<Timer> timers;
+	unsigned long long timerSequence = 0;
+	int running = 0;
+	int holds = 0;
+};
+
+class SingleThreadExecutor : public Executor
+{
+public:
+	// Runs on the calling thread until every spawned task has finished
+	void Run();
+};
+
+class ThreadPoolExecutor : public Executor
+{
+public:
+	// Starts the worker threads right away, they wait for Run() and stay around until the executor is destroyed,
+	// so keeping one executor for many batches only pays for starting threads once
+	explicit ThreadPoolExecutor(int threadCount);
+	~ThreadPoolExecutor() override;
+
+	ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+	ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+
+	// Runs on 'threadCount' threads and returns once every spawned task has finished, then it can be used again
+	void Run();
+
+	int GetThreadCount() const { return threadCount; }
+
+private:
+	void WorkerThread();
+
+	int threadCount;
+
+	// Run() bumps the generation to start the workers, and waits until all of them have finished it
+	std::mutex runMutex;
+	std::condition_variable runChanged;
+	unsigned long long generation = 0;
+	int finished = 0;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+};
+
+/*
+ * Task<T>
+ *
+ * Tasks are lazy, they don't start until someone co_awaits them.
+ * When the task finishes it jumps straight back into whoever was awaiting it.
+ */
+
+template <typename T>
+class Task;
+
+namespace Detail
+{
+	struct TaskPromiseBase
+	{
+		std::coroutine_handle<> continuation;
+		std::exception_ptr exception;
+
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+
+			template <typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+			{
+				auto next = handle.promise().continuation;
+				return next ? next : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		std::suspend_always initial_suspend() const noexcept { return {}; }
+		FinalAwaiter final_suspend() const noexcept { return {}; }
+		void unhandled_exception() { exception = std::current_exception(); }
+	};
+
+	template <typename T>
+	struct TaskPromise : TaskPromiseBase
+	{
+		std::optional<T> value;
+
+		Task<T> get_return_object();
+		void return_value(T newValue) { value = std::move(newValue); }
+
+		T Result()
+		{
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+			return std::move(*value);
+		}
+	};
+
+	template <>
+	struct TaskPromise<void> : TaskPromiseBase
+	{
+		Task<void> get_return_object();
+		void return_void() {}
+
+		void Result()
+		{
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+	};
+}
+
+template <typename T = void>
+class Task
+{
+public:
+	using promise_type = Detail::TaskPromise<T>;
+
+	explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+	Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+
+	~Task()
+	{
+		if (handle)
+		{
+			handle.destroy();
+		}
+	}
+
+	auto operator co_await() && noexcept
+	{
+		struct Awaiter
+		{
+			std::coroutine_handle<promise_type> handle;
+
+			bool await_ready() const noexcept { return false; }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+
+			T await_resume() { return handle.promise().Result(); }
+		};
+
+		return Awaiter{ handle };
+	}
+
+private:
+	std::coroutine_handle<promise_type> handle;
+};
+
+namespace Detail
+{
+	template <typename T>
+	Task<T> TaskPromise<T>::get_return_object()
+	{
+		return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+	}
+
+	inline Task<void> TaskPromise<void>::get_return_object()
+	{
+		return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+	}
+}
+
+// Starts the task on the executor without waiting for it. The executor's Run() waits for it instead.
+void Spawn(Executor& executor, Task<void> task);
+
+/*
+ * Awaitables - things you can co_await inside a task
+ */
+
+// co_await ScheduleOn(executor) moves the rest of the task onto the executor (and lets others run first)
+struct ScheduleOn
+{
+	Executor& executor;
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) { executor.Schedule(handle); }
+	void await_resume() const noexcept {}
+};
+
+// co_await SleepFor(executor, 10ms) pauses the task without blocking the thread
+struct SleepFor
+{
+	Executor& executor;
+	std::chrono::steady_clock::duration duration;
+
+	bool await_ready() const noexcept { return duration <= std::chrono::steady_clock::duration::zero(); }
+	void await_suspend(std::coroutine_handle<> handle) { executor.ScheduleAt(std::chrono::steady_clock::now() + duration, handle); }
+	void await_resume() const noexcept {}
+};
+
+// co_await ReadAsync(executor, fd, buffer, size) waits until the file or pipe has data and then reads it
+// Returns the number of bytes read, 0 at end of file and -1 on error (errno tells which)
+// On Linux the waiting is done with epoll, elsewhere the read simply happens on the executor
+// Only one task may wait on a file descriptor at a time, a second one gets -1 with errno EEXIST right away
+struct ReadAsync
+{
+	Executor& executor;
+	int fd;
+	void* buffer;
+	std::size_t size;
+
+	// Set when the wait couldn't be started, await_resume() then returns -1
+	int error = 0;
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle);
+	long long await_resume();
+};
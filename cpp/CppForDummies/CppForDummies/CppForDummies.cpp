@@ -5,8 +5,39 @@
 
 #include <iostream>
 #include <array>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 #include "MyDummyClass.h"
+#include "ArrayAlgorithms.h"
 #include "BetterDummyClass.h"
+#include "ConcurrentDummyClass.h"
+#include "Coroutines.h"
+#include "AllocationTracker.h"
+#include "InternedName.h"
+#include "SmallString.h"
+#include "FlatHashMap.h"
+#include "InputDispatcher.h"
+#include "SignificanceManager.h"
+#include "SnapshotReplication.h"
+#include "BlendSpace.h"
+#include "PathFinder.h"
+#include "PackageFile.h"
+#include "DependencyIndex.h"
+#include "DummyArchive.h"
+#include "NumericKernels.h"
+#include "Stopwatch.h"
+#include "Benchmarks.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 void Pointers()
 {
@@ -53,6 +84,9 @@ void Classes()
 {
     // Nested scope to show-case destructor
     {
+        // Everything allocated inside this scope is counted towards MyDummyClass when running "CppForDummies track"
+        AllocationScope allocationScope("MyDummyClass");
+
         // First we create the class, this automatically calls the class construtor
         MyDummyClass myClass;
 
@@ -69,8 +103,27 @@ void Classes()
 
     // Create the class that inherited MyDummyClass
     // Note that it still outputs the stuff from the MyDummyClass constructor
-    BetterDummyClass myClass;
-    myClass.SetPrivateNum(11);
+    {
+        AllocationScope allocationScope("BetterDummyClass");
+
+        BetterDummyClass myClass;
+        myClass.SetPrivateNum(11);
+    }
+
+    /*
+     * The classes above live on the 'stack', they are destroyed automatically at the end of their scope
+     *
+     * The 'new' keyword creates the class on the 'heap' instead and gives us a pointer to it
+     * Heap objects live until we destroy them ourselves with 'delete', forgetting to do so is called a memory leak
+     * Allocating on the heap is also a lot slower than using the stack
+     */
+    {
+        AllocationScope allocationScope("MyDummyClass");
+
+        auto heapClass = new MyDummyClass();
+        heapClass->SetPrivateNum(7);
+        delete heapClass;
+    }
 }
 
 void Arrays()
@@ -110,6 +163,22 @@ void Arrays()
     {
         std::cout << "Arrays - Colon operator loop: " << val << std::endl;
     }
+
+    /*
+     * The size of a std::array is part of its type, so the compiler always knows it
+     * ArrayAlgorithms.h has versions of the usual algorithms that make use of that, and they're constexpr:
+     * with an array that's known while compiling, the compiler works out the answer itself
+     */
+    constexpr std::array<int, 6> scores = { 42, 7, 19, 88, 3, 56 };
+    static_assert(ArraySum(scores) == 215);
+    constexpr auto sortedScores = ArraySort(scores);
+
+    std::cout << "Arrays - Sum: " << ArraySum(myArray) << ", biggest: " << ArrayMax(myArray) << std::endl;
+    std::cout << "Arrays - 25 is at index " << ArrayFind(myArray, 25) << std::endl;
+    for (auto score : sortedScores)
+    {
+        std::cout << "Arrays - Sorted at compile time: " << score << std::endl;
+    }
 }
 
 void Loops()
@@ -660,19 +729,707 @@ void Variables()
     nonConstantGravity = 7.0f;
 }
 
-int main()
+void Strings()
+{
+    /*
+     * As mentioned in Variables(), C++ has no built in string type, so libraries bring their own
+     *
+     * std::string is the standard one
+     * SmallString (see SmallString.h) is like std::string, but can hold up to 55 characters without allocating any heap memory
+     *      Similar to how UE4's FString is used for text you want to change
+     *
+     * SmallString is not faster than std::string. "bench strings" shows it a little slower to construct and compare:
+     * std::string also keeps up to 15 characters inside itself, and SmallString is twice its size, so fewer fit in the cache.
+     * What it saves is the heap allocation for text of 16 to 55 characters, which matters when memory is allocated a lot
+     * (run "CppForDummies track" in a Debug build to count allocations), not for raw speed.
+     */
+    SmallString binding = "MoveForward";
+    binding += "Rate";
+
+    std::cout << "Strings - SmallString: " << binding.ToStringView() << ", length " << binding.Len() << ", inline: " << binding.IsInline() << std::endl;
+
+    /*
+     * Comparing two strings means comparing them character by character, which gets slow when it happens millions of times
+     *
+     * An InternedName (see InternedName.h) stores every distinct text only once in a big global table and is itself just a number
+     * Two names with the same text always get the same number, so comparing them is comparing two numbers
+     *      This is exactly what UE4's FName does, it's used for things like input binding names and asset paths
+     */
+    InternedName moveForward("MoveForward");
+    InternedName alsoMoveForward(std::string("Move") + "Forward");
+    InternedName lookUpRate("LookUpRate");
+
+    std::cout << "Strings - InternedName " << moveForward.ToStringView() << " has id " << moveForward.GetId() << std::endl;
+    std::cout << "Strings - Same text, same name: " << (moveForward == alsoMoveForward) << std::endl;
+    std::cout << "Strings - Different text, different name: " << (moveForward == lookUpRate) << std::endl;
+}
+
+void Maps()
+{
+    /*
+     * Maps store values under a key, like a dictionary stores explanations under words
+     *
+     * Looking up a key is very fast, no matter how many elements the map has
+     * UE4 has TMap for this, the standard library has std::map and std::unordered_map
+     *
+     * FlatHashMap (see FlatHashMap.h) works like TMap
+     */
+    FlatHashMap<InternedName, float> axisValues;
+
+    axisValues.Add(InternedName("MoveForward"), 1.0f);
+    axisValues.Add(InternedName("MoveRight"), -0.5f);
+
+    // operator[] adds the key if it doesn't exist yet
+    axisValues[InternedName("LookUpRate")] = 0.25f;
+
+    // Find returns a pointer to the value, or nullptr if the key isn't in the map
+    auto moveRight = axisValues.Find(InternedName("MoveRight"));
+    if (moveRight != nullptr)
+    {
+        std::cout << "Maps - MoveRight: " << *moveRight << std::endl;
+    }
+
+    std::cout << "Maps - Contains Jump: " << axisValues.Contains(InternedName("Jump")) << std::endl;
+
+    axisValues.Remove(InternedName("MoveForward"));
+
+    // Maps support the colon operator loop too, every element has a Key and a Value
+    // Note that the order of the elements is not the order they were added in
+    for (const auto& element : axisValues)
+    {
+        std::cout << "Maps - Colon operator loop: " << element.Key.ToStringView() << " = " << element.Value << std::endl;
+    }
+}
+
+void InputQueue()
+{
+    /*
+     * In the UE4 character (CppProjectCharacter.cpp) input is bound to functions, which are called the moment input arrives
+     *
+     * InputDispatcher (see InputDispatcher.h) lets another thread post the input as events instead
+     * The game thread then applies everything that arrived at a time that suits it, by calling Dispatch()
+     *
+     * The dispatcher is fairly big (it holds a queue of 4096 events), so we create it on the heap
+     */
+    auto dispatcher = std::make_unique<InputDispatcher>();
+
+    auto jumping = false;
+    auto forward = 0.0f;
+    auto turn = 0.0f;
+
+    // The lambdas [&] { ... } are small unnamed functions, [&] lets them change the variables above
+    dispatcher->BindAction("Jump", InputEventType::Pressed, [&] { jumping = true; });
+    dispatcher->BindAction("Jump", InputEventType::Released, [&] { jumping = false; });
+    dispatcher->BindAxis("MoveForward", [&](float value) { forward = value; });
+    dispatcher->BindAxis("Turn", [&](float value) { turn += value; }, AxisCoalesce::Sum);
+
+    // The input thread
+    std::thread inputThread([&]
+    {
+        const InternedName jump("Jump");
+        const InternedName moveForward("MoveForward");
+        const InternedName turnName("Turn");
+
+        dispatcher->PostAction(jump, true);
+        dispatcher->PostAxis(moveForward, 0.5f);
+        dispatcher->PostAxis(moveForward, 1.0f);
+        dispatcher->PostAxis(turnName, 2.0f);
+        dispatcher->PostAxis(turnName, 3.0f);
+    });
+
+    inputThread.join();
+
+    // The game thread, this would normally happen once per frame
+    auto stats = dispatcher->Dispatch();
+
+    std::cout << "InputQueue - Events: " << stats.events << std::endl;
+    std::cout << "InputQueue - Jumping: " << jumping << std::endl;
+    std::cout << "InputQueue - Forward (newest value): " << forward << std::endl;
+    std::cout << "InputQueue - Turn (sum of values): " << turn << std::endl;
+}
+
+void Replication()
 {
+    /*
+     * In multiplayer games the server sends every character's position, rotation and so on to every client, many times per second
+     * SnapshotReplication.h shows how to make that data small, by rounding values (quantization) and only sending changes (delta encoding)
+     */
+    CharacterState character;
+    character.locationX = 120.37f;
+    character.locationY = -840.6f;
+    character.locationZ = 96.0f;
+    character.yaw = 45.0f;
+    character.velocityX = 600.0f;
+
+    std::vector<ReplicatedCharacter> characters = { { 0, Quantize(character) } };
+
+    SnapshotSender server;
+    SnapshotReceiver client;
+    BitWriter packet;
+
+    // The first snapshot has nothing to compare against, so everything is sent
+    server.Encode(characters, packet);
+    const auto& first = packet.Finish();
+    client.Decode(first.data(), first.size());
+    std::cout << "Replication - First snapshot: " << first.size() << " bytes" << std::endl;
+
+    // The client confirms it received the snapshot
+    server.Acknowledge(client.GetLatestSequence());
+
+    // The character moved a little bit, now only the change is sent
+    character.locationX += 10.0f;
+    characters[0].state = Quantize(character);
+
+    packet.Reset();
+    server.Encode(characters, packet);
+    const auto& second = packet.Finish();
+    client.Decode(second.data(), second.size());
+    std::cout << "Replication - Second snapshot: " << second.size() << " bytes" << std::endl;
+
+    // Quantization rounded the location to whole centimeters
+    auto received = Dequantize(client.GetCharacters()[0].state);
+    std::cout << "Replication - Client location: " << received.locationX << ", " << received.locationY << ", " << received.locationZ << std::endl;
+}
+
+void Significance()
+{
+    /*
+     * Characters far away from the camera don't need to update every frame, nobody would notice
+     * SignificanceManager (see SignificanceManager.h) decides how often every character ticks
+     */
+    SignificanceManager manager;
+
+    // Three characters in front of the camera: 5 m, 30 m and 300 m away
+    const float distances[] = { 500.0f, 3000.0f, 30000.0f };
+    int ticks[] = { 0, 0, 0 };
+
+    // Register() hands out a handle, everything else asks about the object through it
+    SignificanceManager::Handle handles[3];
+    for (auto i = 0; i < 3; i++)
+    {
+        handles[i] = manager.Register([&ticks, i](float) { ticks[i]++; });
+        manager.SetLocation(handles[i], distances[i], 0.0f, 0.0f);
+    }
+
+    // The camera is at 0, 0, 0 looking along X. Run 16 frames at 60 frames per second, without a time budget.
+    SignificanceView camera;
+    for (auto frame = 0; frame < 16; frame++)
+    {
+        manager.Update(camera, 1.0f / 60.0f, 0.0);
+    }
+
+    for (auto i = 0; i < 3; i++)
+    {
+        std::cout << "Significance - Character at " << distances[i] / 100.0f << " m: tier " << manager.GetTier(handles[i]) << ", ticked " << ticks[i] << " of 16 frames" << std::endl;
+    }
+}
+
+void BlendSpaces()
+{
+    /*
+     * ThirdPerson_IdleRun_2D mixes the idle, walk and run animations by how fast the character moves
+     * BlendSpace2D (see BlendSpace.h) does the same without the engine
+     *
+     * Our made-up skeleton has a single bone, and every animation a single key that bends it forward a bit more
+     */
+    AnimationClip idle, walk, run;
+    const float bendDegrees[] = { 0.0f, 20.0f, 40.0f };
+    AnimationClip* clips[] = { &idle, &walk, &run };
+
+    for (auto i = 0; i < 3; i++)
+    {
+        const auto halfAngle = bendDegrees[i] * 3.14159265f / 180.0f / 2.0f;
+
+        // A quaternion rotating around the Y axis
+        BoneTransform bend;
+        bend.rotation[1] = std::sin(halfAngle);
+        bend.rotation[3] = std::cos(halfAngle);
+
+        Pose key(1);
+        key.SetBone(0, bend);
+        clips[i]->keys.push_back(key);
+    }
+
+    // Only speed matters here, so the Y parameter has 0 divisions, which makes it a 1D blend space like the real one
+    BlendSpace2D blendSpace({ 0.0f, 375.0f, 4 }, { 0.0f, 0.0f, 0 });
+    blendSpace.AddSample(&idle, 0.0f, 0.0f);
+    blendSpace.AddSample(&walk, 93.75f, 0.0f);
+    blendSpace.AddSample(&run, 375.0f, 0.0f);
+    blendSpace.Build();
+
+    Pose pose(1);
+    for (auto speed : { 0.0f, 50.0f, 200.0f, 375.0f })
+    {
+        blendSpace.Evaluate({ speed, 0.0f, 0.0f }, pose);
+
+        const auto bone = pose.GetBone(0);
+        const auto degrees = 2.0f * std::atan2(bone.rotation[1], bone.rotation[3]) * 180.0f / 3.14159265f;
+        std::cout << "BlendSpaces - Speed " << speed << ": bent forward " << degrees << " degrees" << std::endl;
+    }
+}
+
+void Pathfinding()
+{
+    /*
+     * AI characters need to know how to get somewhere without walking into walls
+     * NavigationGrid (see NavigationGrid.h) works out where a capsule like ACppProjectCharacter's can stand,
+     * and PathFinder (see PathFinder.h) finds the shortest way between two cells
+     *
+     * Our level is 40 x 16 cells of 25 cm: a wall with a gap, and a staircase of 20 cm steps up to a platform
+     */
+    HeightField level(40, 16, 25.0f);
+    for (auto y = 0; y < 16; y++)
+    {
+        // The wall, with a gap at the bottom
+        if (y < 9)
+        {
+            level.SetFloor(14, y, 300.0f);
+            level.SetFloor(15, y, 300.0f);
+        }
+
+        // Stairs going right, every step two cells deep, and the platform at the top
+        for (auto x = 24; x < 40; x++)
+        {
+            level.SetFloor(x, y, std::min((x - 24) / 2, 5) * 20.0f);
+        }
+    }
+
+    NavigationGrid grid(level, AgentSettings());
+    PathFinder finder(grid);
+
+    const GridPoint start = { 4, 3 };
+    const GridPoint goal = { 36, 4 };
+    auto path = finder.FindPath(start, goal);
+
+    // The capsule keeps its radius away from walls and the edge of the map, so there's a border of unwalkable cells
+
+    // Draw it: # can't walk, . can walk, * is on the path
+    std::vector<std::string> rows(16, std::string(40, ' '));
+    for (auto y = 0; y < 16; y++)
+    {
+        for (auto x = 0; x < 40; x++)
+        {
+            rows[y][x] = grid.IsWalkable(x, y) ? '.' : '#';
+        }
+    }
+    for (std::size_t i = 0; i + 1 < path.points.size(); i++)
+    {
+        auto point = path.points[i];
+        const auto end = path.points[i + 1];
+        while (point != end)
+        {
+            rows[point.y][point.x] = '*';
+            point.x += (end.x > point.x) - (end.x < point.x);
+            point.y += (end.y > point.y) - (end.y < point.y);
+        }
+        rows[end.y][end.x] = '*';
+    }
+
+    for (const auto& row : rows)
+    {
+        std::cout << "Pathfinding - " << row << std::endl;
+    }
+    std::cout << "Pathfinding - Path length: " << path.length / 100.0f << " m" << std::endl;
+}
+
+void Packages()
+{
+    /*
+     * Every .uasset file starts with tables saying what's inside and what it needs from other packages (see PackageFile.h)
+     * Here we make up a small animation package like Content/Mannequin/Animations/ThirdPersonJump_Start.uasset and read it back
+     *
+     * Imports point at their outer (the object they live in) with negative numbers: -1 is the first import, -2 the second...
+     */
+    std::vector<PackageImport> imports = {
+        { "/Script/CoreUObject", "Package", "/Script/Engine", 0 },
+        { "/Script/CoreUObject", "Package", "/Game/Mannequin/Character/Mesh/UE4_Mannequin_Skeleton", 0 },
+        { "/Script/CoreUObject", "Class", "AnimSequence", -1 },
+        { "/Script/Engine", "Skeleton", "UE4_Mannequin_Skeleton", -2 },
+    };
+    std::vector<PackageExport> exports = { { "AnimSequence", "ThirdPersonJump_Start", 0 } };
+
+    const auto bytes = WritePackage(imports, exports, 1024);
+
+    PackageInfo package;
+    std::string error;
+    if (!ReadPackage(bytes.data(), bytes.size(), package, error))
+    {
+        std::cout << "Packages - Couldn't read the package: " << error << std::endl;
+        return;
+    }
+
+    std::cout << "Packages - " << bytes.size() << " bytes, the header is " << package.totalHeaderSize << " of them" << std::endl;
+    for (const auto& import : package.imports)
+    {
+        std::cout << "Packages - Import: " << import.className << " " << import.objectName << std::endl;
+    }
+    for (const auto& entry : package.exports)
+    {
+        std::cout << "Packages - Export: " << entry.className << " " << entry.objectName << ", " << entry.serialSize << " bytes at " << entry.serialOffset << std::endl;
+    }
+    for (const auto& dependency : package.dependencies)
+    {
+        std::cout << "Packages - Depends on: " << dependency << std::endl;
+    }
+
+    // For a whole folder, "CppForDummies scan <Content folder>" does the same for every package, see DependencyIndex.h
+}
+
+void SharedState()
+{
+    /*
+     * Threads run at the same time, so one thread reading myClass.num while another one writes it can see garbage (a data race)
+     *
+     * ConcurrentDummyClass (see ConcurrentDummyClass.h) lets one thread change a class while others read it safely
+     * The readers get a copy of num and privateNum that always belong together, and they never wait for a lock
+     */
+    BetterDummyClass better;
+    ConcurrentDummyClass shared(better);
+
+    std::atomic<bool> writing{ true };
+    std::atomic<int> mismatches{ 0 };
+
+    // Reader threads check that num and privateNum always come from the same update
+    std::vector<std::thread> readers;
+    for (auto i = 0; i < 2; i++)
+    {
+        readers.emplace_back([&]
+        {
+            while (writing.load())
+            {
+                const auto snapshot = shared.GetSnapshot();
+                if (snapshot.privateNum != snapshot.num * 2)
+                {
+                    mismatches++;
+                }
+            }
+        });
+    }
+
+    // This thread is the writer
+    for (auto i = 1; i <= 1000; i++)
+    {
+        shared.Update([i](MyDummyClass& object)
+        {
+            object.num = i;
+
+            // The parent's version, or the override would print a thousand lines
+            object.MyDummyClass::SetPrivateNum(i * 2);
+        });
+    }
+
+    writing = false;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    std::cout << "SharedState - Num: " << shared.GetNum() << ", private num: " << shared.GetPrivateNum() << std::endl;
+    std::cout << "SharedState - Mismatched reads: " << mismatches.load() << std::endl;
+
+    // SetPrivateNum goes through the virtual function, so BetterDummyClass still prints its protected variable
+    shared.SetPrivateNum(11);
+    std::cout << "SharedState - Private num after the override: " << shared.GetPrivateNum() << std::endl;
+}
+
+void Saving()
+{
+    /*
+     * Objects only live while the program runs. To keep them, we save their members to a file and create them again later
+     *
+     * DummyArchive (see DummyArchive.h) saves MyDummyClass and BetterDummyClass objects, even millions of them, in columns:
+     * first every num, then every privateNum, and so on. Columns compress well and load very quickly.
+     */
+    std::vector<std::unique_ptr<MyDummyClass>> dummies;
+    dummies.push_back(std::make_unique<MyDummyClass>());
+    dummies.push_back(std::make_unique<BetterDummyClass>());
+    dummies[0]->num = 10;
+    dummies[1]->num = 11;
+
+    const auto path = (std::filesystem::temp_directory_path() / "CppForDummiesSaving.col").string();
+    std::string error;
+
+    DummyArchiveWriter writer;
+    if (!writer.Open(path, {}, error))
+    {
+        std::cout << "Saving - " << error << std::endl;
+        return;
+    }
+    for (const auto& dummy : dummies)
+    {
+        // DummyRecord copies the members, including the private and protected ones, and remembers which class it was
+        writer.Write(DummyRecord::FromObject(*dummy));
+    }
+    if (!writer.Close(error))
+    {
+        std::cout << "Saving - " << error << std::endl;
+        return;
+    }
+    dummies.clear();
+
+    DummyArchiveReader reader;
+    if (!reader.Open(path, error))
+    {
+        std::cout << "Saving - " << error << std::endl;
+        return;
+    }
+
+    std::cout << "Saving - Objects in the archive: " << reader.GetRowCount() << std::endl;
+
+    std::vector<DummyRecord> records;
+    for (std::size_t group = 0; group < reader.GetGroupCount(); group++)
+    {
+        reader.ReadRecords(group, records);
+        for (const auto& record : records)
+        {
+            // Creates a MyDummyClass or a BetterDummyClass, whichever was saved
+            dummies.push_back(record.CreateObject());
+            std::cout << "Saving - Loaded a " << (record.type == DummyType::BetterDummyClass ? "BetterDummyClass" : "MyDummyClass") << std::endl;
+        }
+    }
+
+    for (const auto& dummy : dummies)
+    {
+        std::cout << "Saving - Loaded num: " << dummy->num << ", private num: " << dummy->GetPrivateNum() << std::endl;
+    }
+
+    reader.Close();
+    std::filesystem::remove(path);
+}
+
+void Numbers()
+{
+    /*
+     * Variables() showed that float and double can't store every number exactly
+     * Two other ways to store numbers, for when that matters:
+     *
+     * Fixed-point (see FixedPoint.h) is an integer counting in tiny steps, the same bits come out on every machine
+     * Half and BFloat16 (see HalfFloat.h) are floats in 16 bits, half the memory but only about 3 and 2 digits
+     */
+    // Fixed16 isn't more exact than float here (0.1 isn't a whole number of steps either), but it's off by the same amount everywhere
+    const auto tenth = Fixed16::FromFloat(0.1);
+    const auto fifth = Fixed16::FromFloat(0.2);
+    std::cout << "Numbers - float 0.1 + 0.2: " << std::setprecision(10) << 0.1f + 0.2f << std::endl;
+    std::cout << "Numbers - Fixed16 0.1 + 0.2: " << (tenth + fifth).ToDouble() << " (" << (tenth + fifth).GetRaw() << " steps of 1/65536)" << std::endl;
+
+    // The character's TurnAtRate: Rate * BaseTurnRate * DeltaSeconds
+    const auto rate = Fixed16::FromFloat(0.5);
+    const auto baseTurnRate = Fixed16::FromInt(45);
+    const auto deltaSeconds = Fixed16::FromFloat(1.0 / 60.0);
+    std::cout << "Numbers - Yaw per frame in Fixed16: " << (rate * baseTurnRate * deltaSeconds).ToDouble() << std::endl;
+
+    // Q32.32 has more steps after the point, and a much bigger range
+    const auto precise = Fixed32::FromInt(1) / Fixed32::FromInt(3);
+    std::cout << "Numbers - Fixed32 1 / 3: " << precise.ToDouble() << std::endl;
+
+    std::cout << "Numbers - Half 2049: " << Half::FromFloat(2049.0f).ToFloat() << std::endl;
+    std::cout << "Numbers - Half 1 / 3: " << Half::FromFloat(1.0f / 3.0f).ToFloat() << std::endl;
+    std::cout << "Numbers - Half 100000: " << Half::FromFloat(100000.0f).ToFloat() << std::endl;
+    std::cout << "Numbers - BFloat16 100000: " << BFloat16::FromFloat(100000.0f).ToFloat() << std::endl;
+    std::cout << "Numbers - BFloat16 257: " << BFloat16::FromFloat(257.0f).ToFloat() << std::endl;
+
+    // Back to the default number of digits
+    std::cout << std::setprecision(6);
+
+    // Whole arrays are converted with SIMD, see NumericKernels.h
+    const float speeds[] = { 0.0f, 150.0f, 375.5f, 600.0f };
+    Half stored[4];
+    ConvertToHalf(speeds, stored, 4);
+    std::cout << "Numbers - 4 speeds take " << sizeof(speeds) << " bytes as float and " << sizeof(stored) << " bytes as Half" << std::endl;
+}
+
+/*
+ * Some of the lessons above, ported to coroutines
+ *
+ * The return type Task<T> turns a function into a coroutine, and co_return replaces return
+ */
+
+Task<int> QuickMathsAsync()
+{
+    co_return QuickMaths();
+}
+
+Task<int> MultiAsync(int num1, int num2)
+{
+    co_return Multi(num1, num2);
+}
+
+Task<void> FunctionsAsync()
+{
+    // co_await runs the task and gives us its result, just like calling a normal function
+    auto result = co_await QuickMathsAsync();
+    std::cout << "Coroutines - Quick maths: " << result << std::endl;
+
+    std::cout << "Coroutines - Multi: " << co_await MultiAsync(5, 4) << std::endl;
+}
+
+Task<void> LoopsAsync(Executor& executor, const char* name)
+{
+    for (auto i = 0; i < 3; i++)
+    {
+        std::cout << "Coroutines - " << name << " loop: " << i << std::endl;
+
+        // Pause for a bit without blocking the thread, the other loop gets to run in the meantime
+        co_await SleepFor{ executor, std::chrono::milliseconds(1) };
+    }
+}
+
+#ifdef __linux__
+Task<void> ReadPipeAsync(Executor& executor, int fd)
+{
+    char buffer[64];
+
+    // Waits until something has been written into the pipe, without blocking the thread
+    auto length = co_await ReadAsync{ executor, fd, buffer, sizeof(buffer) };
+    std::cout << "Coroutines - Read from pipe: " << std::string(buffer, length > 0 ? length : 0) << std::endl;
+}
+
+Task<void> WritePipeAsync(Executor& executor, int fd)
+{
+    co_await SleepFor{ executor, std::chrono::milliseconds(2) };
+
+    const std::string message = "yay";
+    [[maybe_unused]] auto written = write(fd, message.data(), message.size());
+}
+#endif
+
+void Coroutines()
+{
+    /*
+     * Spawn hands a task over to an executor, Run() then runs everything until all tasks are done
+     * Both loops run "at the same time" on a single thread, taking turns whenever one of them sleeps
+     */
+    SingleThreadExecutor executor;
+
+    Spawn(executor, FunctionsAsync());
+    Spawn(executor, LoopsAsync(executor, "First"));
+    Spawn(executor, LoopsAsync(executor, "Second"));
+
+#ifdef __linux__
+    int fds[2] = { -1, -1 };
+    if (pipe(fds) == 0)
+    {
+        Spawn(executor, ReadPipeAsync(executor, fds[0]));
+        Spawn(executor, WritePipeAsync(executor, fds[1]));
+    }
+#endif
+
+    executor.Run();
+
+#ifdef __linux__
+    close(fds[0]);
+    close(fds[1]);
+#endif
+}
+
+void RunLesson(const char* name, void (*lesson)())
+{
+    // Attributes the heap allocations of the lesson to its name, see AllocationTracker.h
+    AllocationScope allocationScope(name);
+    lesson();
+}
+
+int ScanPackages(const std::string& folder, const std::string& indexFile)
+{
+    DependencyIndex index;
+    if (!indexFile.empty() && !index.Load(indexFile))
+    {
+        std::cout << "No index at " << indexFile << " yet, reading every package" << std::endl;
+    }
+
+    Stopwatch stopwatch;
+    const auto stats = index.Scan(folder, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    const auto seconds = stopwatch.ElapsedSeconds();
+    if (!stats.error.empty())
+    {
+        std::cout << stats.error << std::endl;
+        return 1;
+    }
+
+    auto failed = 0;
+    for (const auto& package : index.GetPackages())
+    {
+        if (!package.error.empty())
+        {
+            std::cout << package.path << ": " << package.error << std::endl;
+            failed++;
+        }
+        else if (indexFile.empty())
+        {
+            std::cout << package.packageName << std::endl;
+            for (const auto& dependency : package.dependencies)
+            {
+                std::cout << "    " << dependency << std::endl;
+            }
+        }
+    }
+
+    std::cout << stats.files << " packages in " << seconds * 1000.0 << " ms: " << stats.parsed << " read, " << stats.rehashed << " known by hash, "
+        << stats.unchanged << " unchanged, " << stats.failed << " failed, " << stats.removed << " removed" << std::endl;
+
+    if (!indexFile.empty() && !index.Save(indexFile))
+    {
+        std::cout << "Couldn't write " << indexFile << std::endl;
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    // "CppForDummies bench [name]" runs the benchmarks instead of the lessons
+    if (argc > 1 && std::string(argv[1]) == "bench")
+    {
+        RunBenchmarks(argc > 2 ? argv[2] : "");
+        return 0;
+    }
+
+    // "CppForDummies scan <Content folder> [index file]" lists what every package depends on, or updates the index file
+    if (argc > 2 && std::string(argv[1]) == "scan")
+    {
+        return ScanPackages(argv[2], argc > 3 ? argv[3] : "");
+    }
+
     // Print 'Cpp For Dummies!', followed by a new line
     // \n is called the newline character
     std::cout << "Cpp For Dummies!\n";
 
-    Variables();
-    Operators();
-    Functions();
-    Scope();
-    Flow();
-    Loops();
-    Arrays();
-    Classes();
-    Pointers();
+    // "CppForDummies track" runs the lessons while counting heap allocations, and prints a report at the end (needs ALLOCATION_TRACKER)
+    const auto track = argc > 1 && std::string(argv[1]) == "track";
+    if (track)
+    {
+        AllocationTracker::Enable();
+    }
+
+    RunLesson("Variables", Variables);
+    RunLesson("Strings", Strings);
+    RunLesson("Operators", Operators);
+    RunLesson("Functions", Functions);
+    RunLesson("Scope", Scope);
+    RunLesson("Flow", Flow);
+    RunLesson("Loops", Loops);
+    RunLesson("Arrays", Arrays);
+    RunLesson("Maps", Maps);
+    RunLesson("Classes", Classes);
+    RunLesson("Pointers", Pointers);
+    RunLesson("Coroutines", Coroutines);
+    RunLesson("InputQueue", InputQueue);
+    RunLesson("Replication", Replication);
+    RunLesson("Significance", Significance);
+    RunLesson("BlendSpaces", BlendSpaces);
+    RunLesson("Pathfinding", Pathfinding);
+    RunLesson("Packages", Packages);
+    RunLesson("SharedState", SharedState);
+    RunLesson("Saving", Saving);
+    RunLesson("Numbers", Numbers);
+
+    if (track && !AllocationTracker::IsAvailable())
+    {
+        std::cout << "Built without ALLOCATION_TRACKER, there are no allocations to report" << std::endl;
+    }
+    else if (track)
+    {
+        AllocationTracker::Disable();
+        AllocationTracker::PrintReport(std::cout);
+    }
 }
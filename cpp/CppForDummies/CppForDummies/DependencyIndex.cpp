@@ -0,0 +1,434 @@
+#include "DependencyIndex.h"
+#include "Coroutines.h"
+#include "MappedFile.h"
+#include "PackageFile.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#define DEPENDENCY_INDEX_STAT 1
+#else
+#define DEPENDENCY_INDEX_STAT 0
+#endif
+
+namespace
+{
+    enum class ScanResult : std::uint8_t
+    {
+        Unchanged,
+        Rehashed,
+        Parsed,
+        Failed,
+    };
+
+    struct ScanJob
+    {
+        std::filesystem::path root;
+        std::vector<std::string> paths;
+        const std::vector<IndexedPackage>* previous = nullptr;
+        FlatHashMap<std::string, std::size_t, FlatHashMapStringHash> previousByPath;
+        FlatHashMap<std::uint64_t, std::size_t> previousByHash;
+
+        std::vector<IndexedPackage> packages;
+        std::vector<ScanResult> results;
+
+        // For unchanged files, the previous entry to move over once all threads are done
+        std::vector<std::size_t> unchangedFrom;
+        std::atomic<std::size_t> next{ 0 };
+        std::atomic<std::uint64_t> bytesRead{ 0 };
+    };
+
+    std::uint64_t ReadWord(const std::uint8_t* data)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        return word;
+    }
+
+    std::string MakePackageName(const std::string& mountPoint, const std::string& path)
+    {
+        const auto dot = path.rfind('.');
+        return mountPoint + "/" + path.substr(0, dot == std::string::npos ? path.size() : dot);
+    }
+
+    // Size and modification time with a single stat() where possible, std::filesystem needs one call for each
+    bool GetFileStamp(const std::filesystem::path& path, std::uint64_t& size, std::int64_t& modifiedTime)
+    {
+#if DEPENDENCY_INDEX_STAT
+        struct stat status;
+        if (stat(path.c_str(), &status) != 0)
+        {
+            return false;
+        }
+        size = static_cast<std::uint64_t>(status.st_size);
+#ifdef __APPLE__
+        modifiedTime = static_cast<std::int64_t>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+        modifiedTime = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+        return true;
+#else
+        std::error_code sizeError;
+        std::error_code timeError;
+        size = std::filesystem::file_size(path, sizeError);
+        modifiedTime = static_cast<std::int64_t>(std::filesystem::last_write_time(path, timeError).time_since_epoch().count());
+        return !sizeError && !timeError;
+#endif
+    }
+
+    ScanResult ScanFile(ScanJob& job, std::size_t index)
+    {
+        auto& package = job.packages[index];
+        package.path = job.paths[index];
+
+        const auto fullPath = job.root / package.path;
+        const auto* old = job.previousByPath.Find(package.path);
+        if (GetFileStamp(fullPath, package.size, package.modifiedTime) && old != nullptr)
+        {
+            const auto& previous = (*job.previous)[*old];
+            if (previous.size == package.size && previous.modifiedTime == package.modifiedTime)
+            {
+                job.unchangedFrom[index] = *old;
+                return ScanResult::Unchanged;
+            }
+        }
+
+        MappedFile file;
+        if (!file.Open(fullPath.string()))
+        {
+            package.hash = 0;
+            package.error = "can't open file";
+            return ScanResult::Failed;
+        }
+
+        job.bytesRead.fetch_add(file.GetSize(), std::memory_order_relaxed);
+        package.size = file.GetSize();
+        package.hash = DependencyIndex::HashBytes(file.GetData(), file.GetSize());
+
+        // Same content as a package we already know, maybe under another name
+        if (const auto* known = job.previousByHash.Find(package.hash))
+        {
+            const auto& previous = (*job.previous)[*known];
+            if (previous.size == package.size)
+            {
+                package.dependencies = previous.dependencies;
+                return ScanResult::Rehashed;
+            }
+        }
+
+        PackageInfo info;
+        if (!ReadPackage(file.GetData(), file.GetSize(), info, package.error))
+        {
+            return ScanResult::Failed;
+        }
+
+        package.dependencies = std::move(info.dependencies);
+        return ScanResult::Parsed;
+    }
+
+    // Every worker takes the next file until none are left
+    Task<void> ScanFiles(ScanJob& job)
+    {
+        for (auto i = job.next.fetch_add(1, std::memory_order_relaxed); i < job.paths.size(); i = job.next.fetch_add(1, std::memory_order_relaxed))
+        {
+            job.results[i] = ScanFile(job, i);
+        }
+        co_return;
+    }
+
+    bool IsPackageFile(const std::filesystem::path& path)
+    {
+        const auto extension = path.extension();
+        return extension == ".uasset" || extension == ".umap";
+    }
+
+    // Splits off everything up to the next tab (or the end of the line)
+    std::string_view NextField(std::string_view& line)
+    {
+        const auto tab = line.find('\t');
+        const auto field = line.substr(0, tab);
+        line = tab == std::string_view::npos ? std::string_view() : line.substr(tab + 1);
+        return field;
+    }
+
+    template <typename Integer>
+    bool ParseField(std::string_view field, Integer& value, int base = 10)
+    {
+        const auto result = std::from_chars(field.data(), field.data() + field.size(), value, base);
+        return result.ec == std::errc() && result.ptr == field.data() + field.size();
+    }
+
+    constexpr const char* IndexHeader = "DependencyIndex\t1";
+}
+
+DependencyIndex::DependencyIndex(std::string mountPoint)
+    : mountPoint(std::move(mountPoint))
+{
+}
+
+std::uint64_t DependencyIndex::HashBytes(const std::uint8_t* data, std::size_t size)
+{
+    // The rounds of xxHash64: four independent lanes so the multiplications can overlap
+    constexpr std::uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+    constexpr std::uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr std::uint64_t Prime3 = 0x165667B19E3779F9ull;
+
+    const auto round = [](std::uint64_t lane, std::uint64_t word) { return std::rotl(lane + word * Prime2, 31) * Prime1; };
+
+    std::uint64_t lanes[4] = { Prime1 + Prime2, Prime2, 0, 0 - Prime1 };
+    std::size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32)
+    {
+        for (auto i = 0; i < 4; i++)
+        {
+            lanes[i] = round(lanes[i], ReadWord(data + offset + i * 8));
+        }
+    }
+
+    auto hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18) + size;
+    for (; offset + 8 <= size; offset += 8)
+    {
+        hash = std::rotl(hash ^ round(0, ReadWord(data + offset)), 27) * Prime1 + Prime3;
+    }
+    for (; offset < size; offset++)
+    {
+        hash = std::rotl(hash ^ data[offset] * Prime3, 11) * Prime1;
+    }
+
+    // Mix the bits so similar files end up with very different hashes
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+ScanStats DependencyIndex::Scan(const std::string& root, int threadCount)
+{
+    ScanJob job;
+    job.root = root;
+    job.previous = &packages;
+
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(job.root, std::filesystem::directory_options::skip_permission_denied, error), end;
+        !error && it != end; it.increment(error))
+    {
+        std::error_code typeError;
+        if (it->is_regular_file(typeError) && IsPackageFile(it->path()))
+        {
+            auto path = it->path().lexically_relative(job.root).generic_string();
+
+            // Tabs and line breaks would break the index file
+            if (path.find_first_of("\t\n\r") == std::string::npos)
+            {
+                job.paths.push_back(std::move(path));
+            }
+        }
+    }
+    if (error)
+    {
+        // Half a listing would drop every package that wasn't reached from the index
+        ScanStats stats;
+        stats.error = "couldn't list " + root + ": " + error.message();
+        return stats;
+    }
+    std::sort(job.paths.begin(), job.paths.end());
+
+    job.previousByPath.Reserve(packages.size());
+    job.previousByHash.Reserve(packages.size());
+    for (std::size_t i = 0; i < packages.size(); i++)
+    {
+        job.previousByPath.Add(packages[i].path, i);
+        if (packages[i].error.empty())
+        {
+            job.previousByHash.Add(packages[i].hash, i);
+        }
+    }
+
+    job.packages.resize(job.paths.size());
+    job.results.resize(job.paths.size());
+    job.unchangedFrom.resize(job.paths.size());
+
+    threadCount = std::clamp(threadCount, 1, static_cast<int>(std::max<std::size_t>(job.paths.size(), 1)));
+    if (threadCount == 1)
+    {
+        for (std::size_t i = 0; i < job.paths.size(); i++)
+        {
+            job.results[i] = ScanFile(job, i);
+        }
+    }
+    else
+    {
+        ThreadPoolExecutor pool(threadCount);
+        for (auto i = 0; i < threadCount; i++)
+        {
+            Spawn(pool, ScanFiles(job));
+        }
+        pool.Run();
+    }
+
+    ScanStats stats;
+    stats.files = job.paths.size();
+    stats.bytesRead = job.bytesRead.load();
+    for (std::size_t i = 0; i < job.results.size(); i++)
+    {
+        // Moved rather than copied, now that no thread can be reading the old entries anymore
+        const auto result = job.results[i];
+        if (result == ScanResult::Unchanged)
+        {
+            job.packages[i] = std::move(packages[job.unchangedFrom[i]]);
+        }
+
+        stats.unchanged += result == ScanResult::Unchanged;
+        stats.rehashed += result == ScanResult::Rehashed;
+        stats.parsed += result == ScanResult::Parsed;
+        stats.failed += result == ScanResult::Failed;
+    }
+
+    // Every previous package that wasn't found again is gone
+    stats.removed = packages.size();
+    for (const auto& path : job.paths)
+    {
+        stats.removed -= job.previousByPath.Contains(path);
+    }
+
+    packages = std::move(job.packages);
+    RebuildLookup();
+    return stats;
+}
+
+void DependencyIndex::RebuildLookup()
+{
+    byPackageName.Empty();
+    byPackageName.Reserve(packages.size());
+    for (std::size_t i = 0; i < packages.size(); i++)
+    {
+        packages[i].packageName = MakePackageName(mountPoint, packages[i].path);
+        byPackageName.Add(packages[i].packageName, i);
+    }
+}
+
+const IndexedPackage* DependencyIndex::Find(std::string_view packageName) const
+{
+    const auto* index = byPackageName.Find(packageName);
+    return index != nullptr ? &packages[*index] : nullptr;
+}
+
+std::vector<std::string> DependencyIndex::GetReferencers(std::string_view packageName) const
+{
+    std::vector<std::string> referencers;
+    for (const auto& package : packages)
+    {
+        if (std::binary_search(package.dependencies.begin(), package.dependencies.end(), packageName))
+        {
+            referencers.push_back(package.packageName);
+        }
+    }
+    return referencers;
+}
+
+/*
+ * The index file is text, one package per line, separated by tabs:
+ *
+ *      path    hash    size    modified time   error   dependencies...
+ */
+
+bool DependencyIndex::Save(const std::string& path) const
+{
+    std::string text = IndexHeader;
+    text += '\n';
+
+    char hash[17];
+    for (const auto& package : packages)
+    {
+        const auto hashEnd = std::to_chars(hash, hash + 16, package.hash, 16).ptr;
+        text += package.path;
+        text += '\t';
+        text.append(hash, hashEnd);
+        text += '\t';
+        text += std::to_string(package.size);
+        text += '\t';
+        text += std::to_string(package.modifiedTime);
+        text += '\t';
+        text += package.error;
+        for (const auto& dependency : package.dependencies)
+        {
+            text += '\t';
+            text += dependency;
+        }
+        text += '\n';
+    }
+
+    // Written next to the old index first, so a crash halfway through never leaves a broken index behind
+    const auto temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(text.data(), static_cast<std::streamsize>(text.size())))
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    return !error;
+}
+
+bool DependencyIndex::Load(const std::string& path)
+{
+    packages.clear();
+    byPackageName.Empty();
+
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+
+    std::string_view text(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+    const auto nextLine = [&text]()
+    {
+        const auto end = text.find('\n');
+        const auto line = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        return line;
+    };
+
+    if (nextLine() != IndexHeader)
+    {
+        return false;
+    }
+
+    while (!text.empty())
+    {
+        auto line = nextLine();
+        IndexedPackage package;
+        package.path = NextField(line);
+
+        const auto valid = ParseField(NextField(line), package.hash, 16) && ParseField(NextField(line), package.size)
+            && ParseField(NextField(line), package.modifiedTime) && !package.path.empty();
+        if (!valid)
+        {
+            packages.clear();
+            return false;
+        }
+
+        package.error = NextField(line);
+        while (!line.empty())
+        {
+            package.dependencies.emplace_back(NextField(line));
+        }
+
+        packages.push_back(std::move(package));
+    }
+
+    RebuildLookup();
+    return true;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+ * DependencyIndex - which package needs which, for a whole Content folder, kept up to date cheaply
+ *
+ * Scan() finds every .uasset and .umap file under a folder and reads its header with ReadPackage() (see PackageFile.h),
+ * on several threads at once. Files are memory-mapped (see MappedFile.h), so only the pages we look at are read.
+ *
+ * The index can be saved to a file and loaded again, and the next Scan() only does the work that's needed:
+ *
+ *      size and modification time unchanged    nothing, not even opening the file
+ *      changed, but the content hash is known  the old result is reused (touched files, or a file that was moved)
+ *      new content                             the header is read
+ *
+ * Packages are named like the engine names them: Content/Mannequin/Animations/ThirdPersonRun.uasset is /Game/Mannequin/Animations/ThirdPersonRun
+ *
+ *      DependencyIndex index;
+ *      index.Load("Saved/DependencyIndex.tsv");
+ *      index.Scan("Content", 8);
+ *      index.Save("Saved/DependencyIndex.tsv");
+ *      auto users = index.GetReferencers("/Game/Mannequin/Character/Mesh/UE4_Mannequin_Skeleton");
+ */
+
+#include "FlatHashMap.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct IndexedPackage
+{
+	// Relative to the scanned folder, with forward slashes
+	std::string path;
+	std::string packageName;
+
+	std::uint64_t hash = 0;
+	std::uint64_t size = 0;
+	std::int64_t modifiedTime = 0;
+
+	// Empty if the header could be read
+	std::string error;
+
+	std::vector<std::string> dependencies;
+};
+
+struct ScanStats
+{
+	std::size_t files = 0;
+
+	// Size and modification time matched, the file wasn't opened
+	std::size_t unchanged = 0;
+
+	// The content hash matched a known package
+	std::size_t rehashed = 0;
+
+	std::size_t parsed = 0;
+	std::size_t failed = 0;
+	std::size_t removed = 0;
+	std::uint64_t bytesRead = 0;
+
+	// Empty if the whole folder could be listed, otherwise the index was left as it was
+	std::string error;
+};
+
+class DependencyIndex
+{
+public:
+	explicit DependencyIndex(std::string mountPoint = "/Game");
+
+	// Returns false if the file is missing or isn't an index, the index is then empty
+	bool Load(const std::string& path);
+	bool Save(const std::string& path) const;
+
+	// Brings the index up to date with the folder, files that are gone are removed from it.
+	// A folder that's missing or can't be listed leaves the index alone and sets ScanStats::error.
+	ScanStats Scan(const std::string& root, int threadCount);
+
+	const std::vector<IndexedPackage>& GetPackages() const { return packages; }
+	const IndexedPackage* Find(std::string_view packageName) const;
+
+	// The packages that import the given one, sorted
+	std::vector<std::string> GetReferencers(std::string_view packageName) const;
+
+	// A fast 64 bit hash, 8 bytes at a time. Not cryptographic, it only tells changed files apart.
+	static std::uint64_t HashBytes(const std::uint8_t* data, std::size_t size);
+
+private:
+	void RebuildLookup();
+
+	std::string mountPoint;
+	std::vector<IndexedPackage> packages;
+	FlatHashMap<std::string, std::size_t, FlatHashMapStringHash> byPackageName;
+};
@@ -0,0 +1,514 @@
+#include "DummyArchive.h"
+#include "BetterDummyClass.h"
+#include "MyDummyClass.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+    constexpr char Magic[8] = { 'D', 'U', 'M', 'M', 'Y', 'C', 'O', 'L' };
+    constexpr std::uint32_t ArchiveVersion = 1;
+
+    // magic, version, column count, row count, directory offset
+    constexpr std::size_t HeaderSize = 32;
+
+    // row count, reserved, then per column: offset, size, encoding, bit width, reserved
+    constexpr std::size_t ColumnEntrySize = 16;
+    constexpr std::size_t GroupEntrySize = 8 + ColumnEntrySize * DummyColumnCount;
+
+    // Columns start on a cache line, which also keeps Raw columns aligned for GetRawColumn
+    constexpr std::size_t ColumnAlignment = 64;
+
+    // Bitpacked values are read 8 bytes at a time, the padding lets the last ones do that without reading past the column
+    constexpr std::size_t BitpackPadding = 8;
+
+    // Keeps a group's columns under 4 GB, their size is stored in 32 bits
+    constexpr std::uint32_t MaxRowsPerGroup = 1u << 26;
+
+    template <typename T>
+    void Put(std::vector<std::uint8_t>& bytes, T value)
+    {
+        const auto size = bytes.size();
+        bytes.resize(size + sizeof(T));
+        std::memcpy(bytes.data() + size, &value, sizeof(T));
+    }
+
+    template <typename T>
+    T Get(const std::uint8_t* bytes)
+    {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+
+    // Maps small negative and positive differences to small numbers: 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+    std::uint32_t ZigZag(std::uint32_t difference)
+    {
+        return (difference << 1) ^ (0u - (difference >> 31));
+    }
+
+    std::uint32_t UnZigZag(std::uint32_t value)
+    {
+        return (value >> 1) ^ (0u - (value & 1));
+    }
+
+    std::size_t DeltaBitpackedSize(std::size_t rowCount, unsigned bitWidth)
+    {
+        if (rowCount == 0)
+        {
+            return 0;
+        }
+        return sizeof(std::int32_t) + ((rowCount - 1) * bitWidth + 7) / 8 + BitpackPadding;
+    }
+
+    // Returns false (and leaves 'bytes' alone) if the packed column wouldn't be smaller than the raw one
+    bool EncodeDeltaBitpacked(const std::vector<std::int32_t>& values, std::vector<std::uint8_t>& bytes, std::uint8_t& bitWidth)
+    {
+        const auto count = values.size();
+        if (count == 0)
+        {
+            return false;
+        }
+
+        std::uint32_t combined = 0;
+        for (std::size_t i = 1; i < count; i++)
+        {
+            combined |= ZigZag(static_cast<std::uint32_t>(values[i]) - static_cast<std::uint32_t>(values[i - 1]));
+        }
+
+        const auto width = static_cast<unsigned>(std::bit_width(combined));
+        if (DeltaBitpackedSize(count, width) >= count * sizeof(std::int32_t))
+        {
+            return false;
+        }
+
+        const auto start = bytes.size();
+        bytes.resize(start + DeltaBitpackedSize(count, width), 0);
+        std::memcpy(bytes.data() + start, &values[0], sizeof(std::int32_t));
+
+        // Collect bits in a 64 bit accumulator and write them out 32 at a time
+        auto* out = bytes.data() + start + sizeof(std::int32_t);
+        std::uint64_t pending = 0;
+        unsigned pendingBits = 0;
+        for (std::size_t i = 1; i < count; i++)
+        {
+            const auto packed = ZigZag(static_cast<std::uint32_t>(values[i]) - static_cast<std::uint32_t>(values[i - 1]));
+            pending |= static_cast<std::uint64_t>(packed) << pendingBits;
+            pendingBits += width;
+            if (pendingBits >= 32)
+            {
+                const auto word = static_cast<std::uint32_t>(pending);
+                std::memcpy(out, &word, sizeof(word));
+                out += sizeof(word);
+                pending >>= 32;
+                pendingBits -= 32;
+            }
+        }
+        while (pendingBits > 0)
+        {
+            *out++ = static_cast<std::uint8_t>(pending);
+            pending >>= 8;
+            pendingBits = pendingBits > 8 ? pendingBits - 8 : 0;
+        }
+
+        bitWidth = static_cast<std::uint8_t>(width);
+        return true;
+    }
+
+    // Calls store(row, value) for every row, in order
+    template <typename Store>
+    void DecodeColumn(const std::uint8_t* data, const Detail::DummyColumnEntry& entry, std::size_t rowCount, Store&& store)
+    {
+        const auto* bytes = data + entry.offset;
+        if (entry.encoding == DummyEncoding::Raw)
+        {
+            for (std::size_t row = 0; row < rowCount; row++)
+            {
+                store(row, Get<std::int32_t>(bytes + row * sizeof(std::int32_t)));
+            }
+            return;
+        }
+
+        if (rowCount == 0)
+        {
+            return;
+        }
+
+        auto value = Get<std::uint32_t>(bytes);
+        store(0, static_cast<std::int32_t>(value));
+
+        // A value starts somewhere in a byte and needs at most 32 more bits, so one 8 byte read always has all of it
+        const auto* packed = bytes + sizeof(std::int32_t);
+        const unsigned width = entry.bitWidth;
+        const auto mask = (std::uint64_t{ 1 } << width) - 1;
+        std::size_t bit = 0;
+        for (std::size_t row = 1; row < rowCount; row++, bit += width)
+        {
+            const auto word = Get<std::uint64_t>(packed + bit / 8);
+            value += UnZigZag(static_cast<std::uint32_t>((word >> (bit % 8)) & mask));
+            store(row, static_cast<std::int32_t>(value));
+        }
+    }
+
+    // The record member each column is loaded into, the type column is handled separately
+    constexpr int DummyRecord::* RecordFields[] = { &DummyRecord::num, &DummyRecord::privateNum, &DummyRecord::protectedNum };
+}
+
+/*
+ * DummyRecord
+ */
+
+DummyRecord DummyRecord::FromObject(const MyDummyClass& object)
+{
+    DummyRecord record;
+    record.num = object.num;
+    record.privateNum = object.privateNum;
+    record.protectedNum = object.protectedNum;
+    record.type = dynamic_cast<const BetterDummyClass*>(&object) ? DummyType::BetterDummyClass : DummyType::MyDummyClass;
+    return record;
+}
+
+void DummyRecord::ApplyTo(MyDummyClass& object) const
+{
+    object.num = num;
+    object.privateNum = privateNum;
+    object.protectedNum = protectedNum;
+}
+
+std::unique_ptr<MyDummyClass> DummyRecord::CreateObject() const
+{
+    std::unique_ptr<MyDummyClass> object;
+    if (type == DummyType::BetterDummyClass)
+    {
+        object = std::make_unique<BetterDummyClass>();
+    }
+    else
+    {
+        object = std::make_unique<MyDummyClass>();
+    }
+    ApplyTo(*object);
+    return object;
+}
+
+/*
+ * DummyArchiveWriter
+ */
+
+DummyArchiveWriter::~DummyArchiveWriter()
+{
+    // Never closed, throw away the unfinished archive
+    if (file.is_open())
+    {
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(temporaryPath, error);
+    }
+}
+
+bool DummyArchiveWriter::Open(const std::string& path, const DummyArchiveOptions& options, std::string& error)
+{
+    if (file.is_open())
+    {
+        error = "The writer is already open";
+        return false;
+    }
+    if (options.rowsPerGroup == 0 || options.rowsPerGroup > MaxRowsPerGroup)
+    {
+        error = "rowsPerGroup must be between 1 and " + std::to_string(MaxRowsPerGroup);
+        return false;
+    }
+
+    this->path = path;
+    this->options = options;
+    temporaryPath = path + ".tmp";
+    offset = 0;
+    rowCount = 0;
+    groups.clear();
+    for (auto& column : pending)
+    {
+        column.clear();
+        column.reserve(options.rowsPerGroup);
+    }
+
+    file.open(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        error = "Can't create " + temporaryPath;
+        return false;
+    }
+
+    // The real header is written in Close(), when the row count and the directory offset are known
+    const std::uint8_t header[HeaderSize] = {};
+    WriteBytes(header, sizeof(header));
+    return true;
+}
+
+void DummyArchiveWriter::Write(const DummyRecord& record)
+{
+    pending[static_cast<std::size_t>(DummyColumn::Num)].push_back(record.num);
+    pending[static_cast<std::size_t>(DummyColumn::PrivateNum)].push_back(record.privateNum);
+    pending[static_cast<std::size_t>(DummyColumn::ProtectedNum)].push_back(record.protectedNum);
+    pending[static_cast<std::size_t>(DummyColumn::Type)].push_back(static_cast<std::int32_t>(record.type));
+    rowCount++;
+
+    if (pending[0].size() == options.rowsPerGroup)
+    {
+        FlushGroup();
+    }
+}
+
+void DummyArchiveWriter::FlushGroup()
+{
+    Detail::DummyGroupEntry group;
+    group.rowCount = static_cast<std::uint32_t>(pending[0].size());
+
+    for (std::size_t column = 0; column < DummyColumnCount; column++)
+    {
+        auto& values = pending[column];
+        auto& entry = group.columns[column];
+
+        // Pad up to the next column start
+        encoded.assign((ColumnAlignment - offset % ColumnAlignment) % ColumnAlignment, 0);
+        const auto padding = encoded.size();
+
+        if (options.encodings[column] == DummyEncoding::DeltaBitpacked && EncodeDeltaBitpacked(values, encoded, entry.bitWidth))
+        {
+            entry.encoding = DummyEncoding::DeltaBitpacked;
+        }
+        else
+        {
+            entry.encoding = DummyEncoding::Raw;
+            encoded.resize(padding + values.size() * sizeof(std::int32_t));
+            std::memcpy(encoded.data() + padding, values.data(), values.size() * sizeof(std::int32_t));
+        }
+
+        entry.offset = offset + padding;
+        entry.size = static_cast<std::uint32_t>(encoded.size() - padding);
+        WriteBytes(encoded.data(), encoded.size());
+        values.clear();
+    }
+
+    groups.push_back(group);
+}
+
+void DummyArchiveWriter::WriteBytes(const void* bytes, std::size_t size)
+{
+    file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+    offset += size;
+}
+
+bool DummyArchiveWriter::Close(std::string& error)
+{
+    if (!file.is_open())
+    {
+        error = "The writer isn't open";
+        return false;
+    }
+
+    if (!pending[0].empty())
+    {
+        FlushGroup();
+    }
+
+    const auto directoryOffset = offset;
+    std::vector<std::uint8_t> directory;
+    directory.reserve(sizeof(std::uint64_t) + groups.size() * GroupEntrySize);
+    Put<std::uint64_t>(directory, groups.size());
+    for (const auto& group : groups)
+    {
+        Put<std::uint32_t>(directory, group.rowCount);
+        Put<std::uint32_t>(directory, 0);
+        for (const auto& entry : group.columns)
+        {
+            Put<std::uint64_t>(directory, entry.offset);
+            Put<std::uint32_t>(directory, entry.size);
+            Put<std::uint8_t>(directory, static_cast<std::uint8_t>(entry.encoding));
+            Put<std::uint8_t>(directory, entry.bitWidth);
+            Put<std::uint16_t>(directory, 0);
+        }
+    }
+    WriteBytes(directory.data(), directory.size());
+
+    std::vector<std::uint8_t> header(Magic, Magic + sizeof(Magic));
+    Put<std::uint32_t>(header, ArchiveVersion);
+    Put<std::uint32_t>(header, static_cast<std::uint32_t>(DummyColumnCount));
+    Put<std::uint64_t>(header, rowCount);
+    Put<std::uint64_t>(header, directoryOffset);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+    file.close();
+    groups.clear();
+
+    std::error_code fileError;
+    if (!file.fail())
+    {
+        std::filesystem::rename(temporaryPath, path, fileError);
+    }
+    if (file.fail() || fileError)
+    {
+        std::filesystem::remove(temporaryPath, fileError);
+        error = "Can't write " + path;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * DummyArchiveReader
+ */
+
+bool DummyArchiveReader::Open(const std::string& path, std::string& error)
+{
+    Close();
+
+    if (!file.Open(path))
+    {
+        error = "Can't open " + path;
+        return false;
+    }
+
+    const auto* data = file.GetData();
+    const auto size = file.GetSize();
+    const auto fail = [&](const std::string& message)
+    {
+        error = path + ": " + message;
+        Close();
+        return false;
+    };
+
+    if (size < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0)
+    {
+        return fail("not a DummyArchive");
+    }
+
+    version = Get<std::uint32_t>(data + 8);
+    if (version != ArchiveVersion)
+    {
+        return fail("unsupported version " + std::to_string(version));
+    }
+    if (Get<std::uint32_t>(data + 12) != DummyColumnCount)
+    {
+        return fail("unexpected column count");
+    }
+
+    rowCount = Get<std::uint64_t>(data + 16);
+    const auto directoryOffset = Get<std::uint64_t>(data + 24);
+    if (directoryOffset < HeaderSize || directoryOffset > size || size - directoryOffset < sizeof(std::uint64_t))
+    {
+        return fail("directory outside the file");
+    }
+
+    const auto groupCount = Get<std::uint64_t>(data + directoryOffset);
+    if (groupCount > (size - directoryOffset - sizeof(std::uint64_t)) / GroupEntrySize)
+    {
+        return fail("directory is truncated");
+    }
+
+    groups.resize(static_cast<std::size_t>(groupCount));
+    std::uint64_t rows = 0;
+    const auto* entryBytes = data + directoryOffset + sizeof(std::uint64_t);
+    for (auto& group : groups)
+    {
+        group.rowCount = Get<std::uint32_t>(entryBytes);
+        entryBytes += 8;
+        rows += group.rowCount;
+
+        for (auto& entry : group.columns)
+        {
+            entry.offset = Get<std::uint64_t>(entryBytes);
+            entry.size = Get<std::uint32_t>(entryBytes + 8);
+            const auto encoding = entryBytes[12];
+            entry.bitWidth = entryBytes[13];
+            entryBytes += ColumnEntrySize;
+
+            // Columns live between the header and the directory
+            if (entry.offset < HeaderSize || entry.offset > directoryOffset || directoryOffset - entry.offset < entry.size)
+            {
+                return fail("column outside the file");
+            }
+
+            std::size_t expectedSize = 0;
+            if (encoding == static_cast<std::uint8_t>(DummyEncoding::Raw))
+            {
+                expectedSize = static_cast<std::size_t>(group.rowCount) * sizeof(std::int32_t);
+                if (entry.offset % alignof(std::int32_t) != 0)
+                {
+                    return fail("misaligned column");
+                }
+            }
+            else if (encoding == static_cast<std::uint8_t>(DummyEncoding::DeltaBitpacked) && entry.bitWidth <= 32)
+            {
+                expectedSize = DeltaBitpackedSize(group.rowCount, entry.bitWidth);
+            }
+            else
+            {
+                return fail("unknown column encoding");
+            }
+
+            if (entry.size != expectedSize)
+            {
+                return fail("column size doesn't match its row count");
+            }
+            entry.encoding = static_cast<DummyEncoding>(encoding);
+        }
+    }
+
+    if (rows != rowCount)
+    {
+        return fail("row groups don't add up to the row count");
+    }
+    return true;
+}
+
+void DummyArchiveReader::Close()
+{
+    file.Close();
+    version = 0;
+    rowCount = 0;
+    groups.clear();
+}
+
+std::span<const std::int32_t> DummyArchiveReader::GetRawColumn(std::size_t group, DummyColumn column) const
+{
+    const auto& entry = GetEntry(group, column);
+    if (entry.encoding != DummyEncoding::Raw)
+    {
+        return {};
+    }
+    return { reinterpret_cast<const std::int32_t*>(file.GetData() + entry.offset), groups[group].rowCount };
+}
+
+void DummyArchiveReader::ReadColumn(std::size_t group, DummyColumn column, std::int32_t* values) const
+{
+    const auto& entry = GetEntry(group, column);
+    if (entry.encoding == DummyEncoding::Raw)
+    {
+        std::memcpy(values, file.GetData() + entry.offset, entry.size);
+        return;
+    }
+    DecodeColumn(file.GetData(), entry, groups[group].rowCount, [values](std::size_t row, std::int32_t value) { values[row] = value; });
+}
+
+void DummyArchiveReader::ReadRecords(std::size_t group, std::vector<DummyRecord>& records) const
+{
+    const auto rows = groups[group].rowCount;
+    records.resize(rows);
+
+    // Straight from the file into the records, without a buffer in between
+    for (std::size_t column = 0; column < DummyColumnCount; column++)
+    {
+        const auto& entry = groups[group].columns[column];
+        if (column == static_cast<std::size_t>(DummyColumn::Type))
+        {
+            DecodeColumn(file.GetData(), entry, rows, [&](std::size_t row, std::int32_t value) { records[row].type = static_cast<DummyType>(value); });
+        }
+        else
+        {
+            const auto field = RecordFields[column];
+            DecodeColumn(file.GetData(), entry, rows, [&](std::size_t row, std::int32_t value) { records[row].*field = value; });
+        }
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+/*
+ * DummyArchive - saving and loading huge numbers of MyDummyClass objects
+ *
+ * Saving objects one after the other (num, privateNum, protectedNum, num, privateNum, ...) is simple, but slow to
+ * load and hard to compress. An archive stores them in columns instead: all the nums, then all the privateNums, etc.
+ * Values in a column look alike, so a column can often be stored as small differences to the value before it:
+ *
+ *      num column      1000 1001 1003 1004 ...    stored as 1000, then +1 +2 +1 ... in 2 bits each instead of 32
+ *
+ * The rows are split into row groups (65536 rows by default), each group has its own four columns:
+ *
+ *      header      "DUMMYCOL", version, row count, where the directory starts
+ *      group 0     num, privateNum, protectedNum, type
+ *      group 1     ...
+ *      directory   for every group: row count, and where each column is and how it's stored
+ *
+ * Writing keeps only one group in memory, so an archive can be much bigger than the memory we have.
+ * Reading memory-maps the file (see MappedFile.h). Columns stored uncompressed can be used right where they are,
+ * without copying them (GetRawColumn), compressed ones are decoded into a buffer of our own (ReadColumn).
+ *
+ *      DummyArchiveWriter writer;
+ *      writer.Open("Saved/Dummies.col", {}, error);
+ *      for (const auto& dummy : dummies)
+ *      {
+ *          writer.Write(DummyRecord::FromObject(*dummy));
+ *      }
+ *      writer.Close(error);
+ *
+ *      DummyArchiveReader reader;
+ *      reader.Open("Saved/Dummies.col", error);
+ *      std::vector<DummyRecord> records;
+ *      reader.ReadRecords(0, records);
+ *
+ * Numbers are stored the way x86 and ARM keep them in memory (little-endian), so the file can be used without converting it.
+ */
+
+#include "MappedFile.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class MyDummyClass;
+
+// Which class an object was, so loading can create the right one
+enum class DummyType : std::int32_t
+{
+	MyDummyClass = 0,
+	BetterDummyClass = 1,
+};
+
+// Everything an archive stores about one object, including the private and protected members (DummyRecord is a friend of MyDummyClass)
+struct DummyRecord
+{
+	int num = 0;
+	int privateNum = 0;
+	int protectedNum = 0;
+	DummyType type = DummyType::MyDummyClass;
+
+	static DummyRecord FromObject(const MyDummyClass& object);
+
+	// Sets the members directly, the SetPrivateNum override of a BetterDummyClass doesn't run
+	void ApplyTo(MyDummyClass& object) const;
+	std::unique_ptr<MyDummyClass> CreateObject() const;
+};
+
+enum class DummyColumn
+{
+	Num,
+	PrivateNum,
+	ProtectedNum,
+	Type,
+	Count,
+};
+
+constexpr std::size_t DummyColumnCount = static_cast<std::size_t>(DummyColumn::Count);
+
+enum class DummyEncoding : std::uint8_t
+{
+	// 4 bytes per value, can be used without copying
+	Raw = 0,
+
+	// The first value, then the differences to the previous value packed into as few bits as the biggest one needs
+	DeltaBitpacked = 1,
+};
+
+struct DummyArchiveOptions
+{
+	std::uint32_t rowsPerGroup = 65536;
+
+	// Per column, DeltaBitpacked falls back to Raw for a group where it wouldn't be smaller
+	std::array<DummyEncoding, DummyColumnCount> encodings = { DummyEncoding::DeltaBitpacked, DummyEncoding::DeltaBitpacked,
+		DummyEncoding::DeltaBitpacked, DummyEncoding::DeltaBitpacked };
+};
+
+namespace Detail
+{
+	// Where a column of a row group is in the file and how it's stored
+	struct DummyColumnEntry
+	{
+		std::uint64_t offset = 0;
+		std::uint32_t size = 0;
+		DummyEncoding encoding = DummyEncoding::Raw;
+		std::uint8_t bitWidth = 0;
+	};
+
+	struct DummyGroupEntry
+	{
+		std::uint32_t rowCount = 0;
+		std::array<DummyColumnEntry, DummyColumnCount> columns;
+	};
+}
+
+class DummyArchiveWriter
+{
+public:
+	DummyArchiveWriter() = default;
+	~DummyArchiveWriter();
+
+	DummyArchiveWriter(const DummyArchiveWriter&) = delete;
+	DummyArchiveWriter& operator=(const DummyArchiveWriter&) = delete;
+
+	// The archive is written next to 'path' and only replaces it in Close(), a crash never leaves half an archive behind
+	bool Open(const std::string& path, const DummyArchiveOptions& options, std::string& error);
+
+	void Write(const DummyRecord& record);
+
+	// Writes the last group and the directory, returns false if anything couldn't be written
+	bool Close(std::string& error);
+
+	std::uint64_t GetRowCount() const { return rowCount; }
+
+private:
+	void FlushGroup();
+	void WriteBytes(const void* bytes, std::size_t size);
+
+	std::ofstream file;
+	std::string path;
+	std::string temporaryPath;
+	DummyArchiveOptions options;
+
+	std::uint64_t offset = 0;
+	std::uint64_t rowCount = 0;
+
+	// The group being filled, one vector per column
+	std::array<std::vector<std::int32_t>, DummyColumnCount> pending;
+	std::vector<std::uint8_t> encoded;
+	std::vector<Detail::DummyGroupEntry> groups;
+};
+
+class DummyArchiveReader
+{
+public:
+	// Checks the header and every directory entry, so the functions below never read outside the file
+	bool Open(const std::string& path, std::string& error);
+	void Close();
+
+	std::uint32_t GetVersion() const { return version; }
+	std::uint64_t GetRowCount() const { return rowCount; }
+	std::size_t GetGroupCount() const { return groups.size(); }
+	std::size_t GetGroupRowCount(std::size_t group) const { return groups[group].rowCount; }
+	DummyEncoding GetEncoding(std::size_t group, DummyColumn column) const { return GetEntry(group, column).encoding; }
+
+	// The column inside the mapped file if it's stored Raw, empty otherwise. Valid until the reader is closed.
+	std::span<const std::int32_t> GetRawColumn(std::size_t group, DummyColumn column) const;
+
+	// Decodes (or copies) a column, 'values' needs room for GetGroupRowCount(group) values
+	void ReadColumn(std::size_t group, DummyColumn column, std::int32_t* values) const;
+
+	// Replaces 'records' with the rows of a group
+	void ReadRecords(std::size_t group, std::vector<DummyRecord>& records) const;
+
+private:
+	const Detail::DummyColumnEntry& GetEntry(std::size_t group, DummyColumn column) const
+	{
+		return groups[group].columns[static_cast<std::size_t>(column)];
+	}
+
+	MappedFile file;
+	std::uint32_t version = 0;
+	std::uint64_t rowCount = 0;
+	std::vector<Detail::DummyGroupEntry> groups;
+};
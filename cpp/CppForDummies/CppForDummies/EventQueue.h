@@ -0,0 +1,160 @@
+#pragma once
+
+/*
+ * Lock-free queues for handing events from one thread to another
+ *
+ * Both queues have a fixed size (Capacity, which must be a power of 2) and never allocate after being created.
+ * TryPush returns false when the queue is full and TryPop returns false when it is empty, neither ever waits.
+ *
+ * SpscQueue - exactly one thread pushes and exactly one thread pops
+ * MpscQueue - any number of threads push, exactly one thread pops
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Keeps values that different threads write on separate cache lines, so they don't slow each other down
+constexpr std::size_t CacheLineSize = 64;
+
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+	bool TryPush(const T& value)
+	{
+		const auto tail = writeIndex.load(std::memory_order_relaxed);
+
+		// Only re-read the consumer's index when our cached copy says the queue is full
+		if (tail - cachedReadIndex == Capacity)
+		{
+			cachedReadIndex = readIndex.load(std::memory_order_acquire);
+			if (tail - cachedReadIndex == Capacity)
+			{
+				return false;
+			}
+		}
+
+		slots[tail & (Capacity - 1)] = value;
+		writeIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPop(T& value)
+	{
+		const auto head = readIndex.load(std::memory_order_relaxed);
+
+		if (head == cachedWriteIndex)
+		{
+			cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+			if (head == cachedWriteIndex)
+			{
+				return false;
+			}
+		}
+
+		value = std::move(slots[head & (Capacity - 1)]);
+		readIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	// Written by the producer
+	alignas(CacheLineSize) std::atomic<std::size_t> writeIndex{ 0 };
+	std::size_t cachedReadIndex = 0;
+
+	// Written by the consumer
+	alignas(CacheLineSize) std::atomic<std::size_t> readIndex{ 0 };
+	std::size_t cachedWriteIndex = 0;
+
+	alignas(CacheLineSize) T slots[Capacity];
+};
+
+/*
+ * Every slot has a sequence number telling whose turn it is:
+ *      sequence == position        the slot is free for the producer claiming 'position'
+ *      sequence == position + 1    the slot holds the value for the consumer reading 'position'
+ *
+ * Producers claim a position with a compare-exchange on the write index, fill the slot and then bump its sequence.
+ * A producer that gets paused halfway only holds up the consumer at that one slot, never the other producers.
+ */
+template <typename T, std::size_t Capacity>
+class MpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+	MpscQueue()
+	{
+		for (std::size_t i = 0; i < Capacity; i++)
+		{
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	bool TryPush(const T& value)
+	{
+		auto position = writeIndex.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			auto& slot = slots[position & (Capacity - 1)];
+			const auto sequence = slot.sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+			if (difference == 0)
+			{
+				// The slot is free, try to claim it. On failure 'position' is updated and we try again.
+				if (writeIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					slot.value = value;
+					slot.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The consumer hasn't emptied this slot yet, the queue is full
+				return false;
+			}
+			else
+			{
+				// Another producer claimed this position, catch up
+				position = writeIndex.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool TryPop(T& value)
+	{
+		auto& slot = slots[readIndex & (Capacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != readIndex + 1)
+		{
+			return false;
+		}
+
+		value = std::move(slot.value);
+
+		// Hand the slot back to the producers for the next round
+		slot.sequence.store(readIndex + Capacity, std::memory_order_release);
+		readIndex++;
+		return true;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<std::size_t> sequence;
+		T value;
+	};
+
+	alignas(CacheLineSize) std::atomic<std::size_t> writeIndex{ 0 };
+
+	// Only the consumer touches this, so it doesn't need to be atomic
+	alignas(CacheLineSize) std::size_t readIndex = 0;
+
+	alignas(CacheLineSize) Slot slots[Capacity];
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+/*
+ * FixedPoint - numbers with a fixed number of bits after the point, built on plain integers
+ *
+ * A float moves its point around: close to 0 it's very precise, at 100000 it can't even tell 100000.001 and 100000.002 apart.
+ * It also depends on the compiler and the CPU whether a * b + c is rounded once or twice, so two machines running the same
+ * simulation can slowly drift apart. That's a problem for lockstep multiplayer and replays.
+ *
+ * A fixed-point number is an integer that counts in steps of 1/65536 (Q16.16) or 1/4294967296 (Q32.32):
+ *
+ *      Fixed16 (Q16.16)    32 bits: 16 for the whole part, 16 after the point    -32768 to 32767.99998, steps of 0.000015
+ *      Fixed32 (Q32.32)    64 bits: 32 for the whole part, 32 after the point    about -2 billion to 2 billion, steps of 0.00000000023
+ *
+ * Adding and subtracting is integer math, so it's exact. Multiplying and dividing round in one way that's written down
+ * below, so every machine gets the very same bits. The precision is the same everywhere in the range, unlike float.
+ *
+ *      const auto baseTurnRate = Fixed16::FromInt(45);
+ *      const auto deltaSeconds = Fixed16::FromFloat(1.0f / 60.0f);
+ *      yaw += rate * baseTurnRate * deltaSeconds;
+ *
+ * Going past the range wraps around like integers do (32767 + 1 is -32768), dividing by 0 gives the biggest or smallest value.
+ * Converting from floating point rounds to the nearest step (halfway goes to the even one), too big values become the biggest one.
+ */
+
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace Detail
+{
+	// Multiplies two 64 bit numbers into 128 bits, adds half a step and keeps bits [FractionBits, FractionBits + 64)
+	template <int FractionBits>
+	constexpr std::int64_t MultiplyShift(std::int64_t a, std::int64_t b)
+	{
+#if defined(__SIZEOF_INT128__)
+		const auto product = static_cast<__int128>(a) * b + (static_cast<__int128>(1) << (FractionBits - 1));
+		return static_cast<std::int64_t>(product >> FractionBits);
+#else
+		// 32 bits at a time, the way it's done on paper
+		const auto ua = static_cast<std::uint64_t>(a);
+		const auto ub = static_cast<std::uint64_t>(b);
+		const auto aLow = ua & 0xFFFFFFFFu;
+		const auto aHigh = ua >> 32;
+		const auto bLow = ub & 0xFFFFFFFFu;
+		const auto bHigh = ub >> 32;
+
+		const auto lowLow = aLow * bLow;
+		const auto middle = aHigh * bLow + (lowLow >> 32);
+		const auto middle2 = aLow * bHigh + (middle & 0xFFFFFFFFu);
+		auto high = aHigh * bHigh + (middle >> 32) + (middle2 >> 32);
+		auto low = (middle2 << 32) | (lowLow & 0xFFFFFFFFu);
+
+		// The above treated a and b as unsigned, a negative number counts 2^64 too much
+		high -= (a < 0 ? ub : 0) + (b < 0 ? ua : 0);
+
+		const auto rounded = low + (std::uint64_t{ 1 } << (FractionBits - 1));
+		high += rounded < low;
+		low = rounded;
+		return static_cast<std::int64_t>((high << (64 - FractionBits)) | (low >> FractionBits));
+#endif
+	}
+
+	// (a << FractionBits) / b rounded toward zero, bit by bit so it needs no 128 bit division
+	template <int FractionBits>
+	constexpr std::int64_t ShiftDivide(std::int64_t a, std::int64_t b)
+	{
+		const auto negative = (a < 0) != (b < 0);
+		const auto dividend = a < 0 ? 0 - static_cast<std::uint64_t>(a) : static_cast<std::uint64_t>(a);
+		const auto divisor = b < 0 ? 0 - static_cast<std::uint64_t>(b) : static_cast<std::uint64_t>(b);
+
+		auto quotient = dividend / divisor;
+		auto remainder = dividend % divisor;
+		for (auto i = 0; i < FractionBits; i++)
+		{
+			// The remainder is below the divisor, which is at most 2^63, so doubling it fits
+			remainder <<= 1;
+			quotient <<= 1;
+			if (remainder >= divisor)
+			{
+				remainder -= divisor;
+				quotient |= 1;
+			}
+		}
+		return static_cast<std::int64_t>(negative ? 0 - quotient : quotient);
+	}
+
+	// Rounds to the nearest integer, halfway to the even one, and clamps to the range of Storage. NaN becomes 0.
+	template <typename Storage>
+	constexpr Storage RoundToStorage(double value)
+	{
+		constexpr auto Limit = static_cast<double>(std::numeric_limits<Storage>::max()) + 1.0;
+		if (value != value)
+		{
+			return 0;
+		}
+		if (value >= Limit)
+		{
+			return std::numeric_limits<Storage>::max();
+		}
+		if (value <= -Limit)
+		{
+			return std::numeric_limits<Storage>::min();
+		}
+
+		auto whole = static_cast<std::int64_t>(value);
+		const auto fraction = value - static_cast<double>(whole);
+		if (fraction > 0.5 || (fraction == 0.5 && (whole & 1) != 0))
+		{
+			whole++;
+		}
+		else if (fraction < -0.5 || (fraction == -0.5 && (whole & 1) != 0))
+		{
+			whole--;
+		}
+
+		// Rounding up can reach Limit itself
+		if (whole > std::numeric_limits<Storage>::max())
+		{
+			return std::numeric_limits<Storage>::max();
+		}
+		return static_cast<Storage>(whole);
+	}
+}
+
+template <typename Storage, int FractionBits>
+class Fixed
+{
+	static_assert(std::is_same_v<Storage, std::int32_t> || std::is_same_v<Storage, std::int64_t>, "Fixed is built on int32_t or int64_t");
+	static_assert(FractionBits > 0 && FractionBits < static_cast<int>(sizeof(Storage) * 8) - 1, "Leave at least one whole bit and the sign");
+
+	using Unsigned = std::make_unsigned_t<Storage>;
+
+public:
+	using StorageType = Storage;
+	static constexpr int FractionBitCount = FractionBits;
+	static constexpr Storage One = Storage{ 1 } << FractionBits;
+
+	constexpr Fixed() = default;
+
+	static constexpr Fixed FromRaw(Storage raw)
+	{
+		Fixed result;
+		result.raw = raw;
+		return result;
+	}
+
+	static constexpr Fixed FromInt(Storage value)
+	{
+		return FromRaw(static_cast<Storage>(static_cast<Unsigned>(value) << FractionBits));
+	}
+
+	static constexpr Fixed FromFloat(double value)
+	{
+		return FromRaw(Detail::RoundToStorage<Storage>(value * static_cast<double>(One)));
+	}
+
+	static constexpr Fixed Max() { return FromRaw(std::numeric_limits<Storage>::max()); }
+	static constexpr Fixed Min() { return FromRaw(std::numeric_limits<Storage>::min()); }
+
+	constexpr Storage GetRaw() const { return raw; }
+
+	// The whole part, rounded down (-1.5 gives -2)
+	constexpr Storage ToInt() const { return raw >> FractionBits; }
+
+	constexpr float ToFloat() const { return static_cast<float>(raw) * (1.0f / static_cast<float>(One)); }
+	constexpr double ToDouble() const { return static_cast<double>(raw) * (1.0 / static_cast<double>(One)); }
+
+	constexpr Fixed operator+(Fixed other) const { return FromRaw(static_cast<Storage>(static_cast<Unsigned>(raw) + static_cast<Unsigned>(other.raw))); }
+	constexpr Fixed operator-(Fixed other) const { return FromRaw(static_cast<Storage>(static_cast<Unsigned>(raw) - static_cast<Unsigned>(other.raw))); }
+	constexpr Fixed operator-() const { return FromRaw(static_cast<Storage>(Unsigned{ 0 } - static_cast<Unsigned>(raw))); }
+
+	// Rounded to the nearest step, halfway rounds up
+	constexpr Fixed operator*(Fixed other) const
+	{
+		if constexpr (sizeof(Storage) == 4)
+		{
+			const auto product = static_cast<std::int64_t>(raw) * other.raw + (std::int64_t{ 1 } << (FractionBits - 1));
+			return FromRaw(static_cast<Storage>(product >> FractionBits));
+		}
+		else
+		{
+			return FromRaw(Detail::MultiplyShift<FractionBits>(raw, other.raw));
+		}
+	}
+
+	// Rounded toward zero
+	constexpr Fixed operator/(Fixed other) const
+	{
+		if (other.raw == 0)
+		{
+			return raw < 0 ? Min() : (raw > 0 ? Max() : Fixed());
+		}
+		if constexpr (sizeof(Storage) == 4)
+		{
+			const auto shifted = static_cast<std::int64_t>(static_cast<std::uint64_t>(static_cast<std::int64_t>(raw)) << FractionBits);
+			return FromRaw(static_cast<Storage>(shifted / other.raw));
+		}
+		else
+		{
+			return FromRaw(Detail::ShiftDivide<FractionBits>(raw, other.raw));
+		}
+	}
+
+	constexpr Fixed& operator+=(Fixed other) { return *this = *this + other; }
+	constexpr Fixed& operator-=(Fixed other) { return *this = *this - other; }
+	constexpr Fixed& operator*=(Fixed other) { return *this = *this * other; }
+	constexpr Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+	constexpr bool operator==(const Fixed&) const = default;
+	constexpr auto operator<=>(const Fixed&) const = default;
+
+private:
+	Storage raw = 0;
+};
+
+using Fixed16 = Fixed<std::int32_t, 16>;
+using Fixed32 = Fixed<std::int64_t, 32>;
@@ -0,0 +1,426 @@
+#pragma once
+
+/*
+ * FlatHashMap - a stand-in for UE4's TMap
+ *
+ * std::unordered_map allocates every element separately and links them together, so a lookup jumps around memory.
+ * FlatHashMap keeps all elements in one big array instead ("open addressing"), next to a small array of control bytes.
+ *
+ * Every element has one control byte: either 'empty', or 7 bits of the element's hash.
+ * A lookup compares 16 control bytes at once with a single SIMD instruction, and only looks at an actual key
+ * when those 7 bits match. Misses almost never touch the element array at all.
+ *
+ * Elements sit at the first free slot at or after their 'home' slot (linear probing), and removing an element
+ * shifts the following ones back, so there are never any 'deleted' markers slowing down later lookups.
+ *
+ * The API follows TMap: Add, FindOrAdd, Find (returns a pointer, nullptr if missing), Contains, Remove, Num
+ * Iterating gives elements with .Key and .Value, just like TMap:
+ *
+ *      for (auto& element : map)
+ *      {
+ *          std::cout << element.Key << " = " << element.Value << std::endl;
+ *      }
+ *
+ * Adding or removing elements moves other elements around, so pointers and iterators into the map become invalid.
+ *
+ * Lookups with a different type than the key (like a std::string_view into a map of std::string) work when both
+ * the hasher and the key comparer are 'transparent', see FlatHashMapStringHash below.
+ */
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLAT_HASH_MAP_SSE2 1
+#else
+#define FLAT_HASH_MAP_SSE2 0
+#endif
+
+// Lets a FlatHashMap<std::string, ...> be searched with std::string_view or const char* without creating a std::string
+struct FlatHashMapStringHash
+{
+	using is_transparent = void;
+
+	std::size_t operator()(std::string_view text) const noexcept { return std::hash<std::string_view>()(text); }
+};
+
+template <typename KeyType, typename ValueType, typename Hasher = std::hash<KeyType>, typename KeyEqual = std::equal_to<>>
+class FlatHashMap
+{
+public:
+	struct ElementType
+	{
+		KeyType Key;
+		ValueType Value;
+	};
+
+	FlatHashMap() = default;
+
+	FlatHashMap(const FlatHashMap& other)
+	{
+		Reserve(other.Num());
+		for (const auto& element : other)
+		{
+			Add(element.Key, element.Value);
+		}
+	}
+
+	FlatHashMap(FlatHashMap&& other) noexcept
+		: elements(std::exchange(other.elements, nullptr)), control(std::exchange(other.control, nullptr)),
+		  capacity(std::exchange(other.capacity, 0)), count(std::exchange(other.count, 0))
+	{
+	}
+
+	FlatHashMap& operator=(FlatHashMap other) noexcept
+	{
+		std::swap(elements, other.elements);
+		std::swap(control, other.control);
+		std::swap(capacity, other.capacity);
+		std::swap(count, other.count);
+		return *this;
+	}
+
+	~FlatHashMap()
+	{
+		Release();
+	}
+
+	std::size_t Num() const { return count; }
+	bool IsEmpty() const { return count == 0; }
+
+	// Removes every element and frees the memory
+	void Empty()
+	{
+		Release();
+		elements = nullptr;
+		control = nullptr;
+		capacity = 0;
+		count = 0;
+	}
+
+	// Makes room for 'number' elements, so adding them doesn't have to grow the map over and over
+	void Reserve(std::size_t number)
+	{
+		auto newCapacity = GroupWidth;
+		while (newCapacity * MaxLoadNumerator / MaxLoadDenominator < number)
+		{
+			newCapacity *= 2;
+		}
+
+		if (newCapacity > capacity)
+		{
+			Rehash(newCapacity);
+		}
+	}
+
+	// Adds the element, or replaces the value if the key already exists
+	template <typename K, typename V>
+	ValueType& Add(K&& key, V&& value)
+	{
+		auto& slot = FindOrAdd(std::forward<K>(key));
+		slot = std::forward<V>(value);
+		return slot;
+	}
+
+	// Returns the value for the key, adding a default constructed one if it doesn't exist yet
+	template <typename K>
+	ValueType& FindOrAdd(K&& key)
+	{
+		const auto hash = Hash(key);
+		auto index = FindIndex(key, hash);
+		if (index == NotFound)
+		{
+			if (count + 1 > capacity * MaxLoadNumerator / MaxLoadDenominator)
+			{
+				Rehash(capacity == 0 ? GroupWidth : capacity * 2);
+			}
+
+			index = FindEmptyIndex(hash);
+			new (&elements[index]) ElementType{ KeyType(std::forward<K>(key)), ValueType() };
+			SetControl(index, H2(hash));
+			count++;
+		}
+		return elements[index].Value;
+	}
+
+	ValueType& operator[](const KeyType& key) { return FindOrAdd(key); }
+
+	template <typename K>
+	ValueType* Find(const K& key)
+	{
+		const auto index = FindIndex(key, Hash(key));
+		return index == NotFound ? nullptr : &elements[index].Value;
+	}
+
+	template <typename K>
+	const ValueType* Find(const K& key) const
+	{
+		const auto index = FindIndex(key, Hash(key));
+		return index == NotFound ? nullptr : &elements[index].Value;
+	}
+
+	template <typename K>
+	bool Contains(const K& key) const
+	{
+		return FindIndex(key, Hash(key)) != NotFound;
+	}
+
+	// Returns the number of removed elements, 0 or 1
+	template <typename K>
+	std::size_t Remove(const K& key)
+	{
+		auto index = FindIndex(key, Hash(key));
+		if (index == NotFound)
+		{
+			return 0;
+		}
+
+		elements[index].~ElementType();
+
+		/*
+		 * Backward shift deletion
+		 * Walk the elements after the hole. Any element that is allowed to live in the hole (its home slot is not
+		 * between the hole and where it sits now) moves back into it, and the hole moves to where it came from.
+		 * The first empty slot ends the run.
+		 */
+		auto hole = index;
+		auto next = (index + 1) & Mask();
+		while (control[next] != EmptyControl)
+		{
+			const auto home = static_cast<std::size_t>(H1(Hash(elements[next].Key))) & Mask();
+
+			// Distance from the home slot, counting around the end of the array
+			const auto nextDistance = (next - home) & Mask();
+			const auto holeDistance = (hole - home) & Mask();
+			if (holeDistance <= nextDistance)
+			{
+				new (&elements[hole]) ElementType(std::move(elements[next]));
+				elements[next].~ElementType();
+				SetControl(hole, control[next]);
+				hole = next;
+			}
+
+			next = (next + 1) & Mask();
+		}
+
+		SetControl(hole, EmptyControl);
+		count--;
+		return 1;
+	}
+
+	/*
+	 * Iteration
+	 */
+
+	template <bool IsConst>
+	class Iterator
+	{
+	public:
+		using MapType = std::conditional_t<IsConst, const FlatHashMap, FlatHashMap>;
+		using Reference = std::conditional_t<IsConst, const ElementType&, ElementType&>;
+
+		Iterator(MapType* map, std::size_t index) : map(map), index(index) { SkipEmpty(); }
+
+		Reference operator*() const { return map->elements[index]; }
+		auto operator->() const { return &map->elements[index]; }
+
+		Iterator& operator++()
+		{
+			index++;
+			SkipEmpty();
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const { return index == other.index; }
+		bool operator!=(const Iterator& other) const { return index != other.index; }
+
+	private:
+		void SkipEmpty()
+		{
+			while (index < map->capacity && map->control[index] == EmptyControl)
+			{
+				index++;
+			}
+		}
+
+		MapType* map;
+		std::size_t index;
+	};
+
+	Iterator<false> begin() { return Iterator<false>(this, 0); }
+	Iterator<false> end() { return Iterator<false>(this, capacity); }
+	Iterator<true> begin() const { return Iterator<true>(this, 0); }
+	Iterator<true> end() const { return Iterator<true>(this, capacity); }
+
+private:
+	static constexpr std::size_t GroupWidth = 16;
+	static constexpr std::size_t MaxLoadNumerator = 7;
+	static constexpr std::size_t MaxLoadDenominator = 8;
+	static constexpr std::size_t NotFound = ~std::size_t(0);
+	static constexpr std::uint8_t EmptyControl = 0x80;
+
+	std::size_t Mask() const { return capacity - 1; }
+
+	// Mixes the user's hash, std::hash of an integer is often the integer itself
+	template <typename K>
+	std::uint64_t Hash(const K& key) const
+	{
+		auto hash = static_cast<std::uint64_t>(Hasher()(key)) * 0x9E3779B97F4A7C15ull;
+		return hash ^ (hash >> 32);
+	}
+
+	static std::uint64_t H1(std::uint64_t hash) { return hash >> 7; }
+	static std::uint8_t H2(std::uint64_t hash) { return static_cast<std::uint8_t>(hash & 0x7F); }
+
+	// The control array has GroupWidth extra bytes at the end that mirror the first ones,
+	// so a group that starts near the end can be loaded in one go without wrapping around
+	void SetControl(std::size_t index, std::uint8_t value)
+	{
+		control[index] = value;
+		if (index < GroupWidth)
+		{
+			control[capacity + index] = value;
+		}
+	}
+
+	// Bit i is set when control byte i of the group matches
+	struct GroupMasks
+	{
+		std::uint32_t match;
+		std::uint32_t empty;
+	};
+
+	static GroupMasks MatchGroup(const std::uint8_t* group, std::uint8_t h2)
+	{
+#if FLAT_HASH_MAP_SSE2
+		const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+		const auto match = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(h2))));
+
+		// Only 'empty' has the top bit set, and movemask collects exactly the top bits
+		const auto empty = _mm_movemask_epi8(bytes);
+		return { static_cast<std::uint32_t>(match), static_cast<std::uint32_t>(empty) };
+#else
+		GroupMasks masks{ 0, 0 };
+		for (std::size_t i = 0; i < GroupWidth; i++)
+		{
+			masks.match |= static_cast<std::uint32_t>(group[i] == h2) << i;
+			masks.empty |= static_cast<std::uint32_t>(group[i] == EmptyControl) << i;
+		}
+		return masks;
+#endif
+	}
+
+	template <typename K>
+	std::size_t FindIndex(const K& key, std::uint64_t hash) const
+	{
+		if (capacity == 0)
+		{
+			return NotFound;
+		}
+
+		auto position = static_cast<std::size_t>(H1(hash)) & Mask();
+		const auto h2 = H2(hash);
+
+		while (true)
+		{
+			const auto masks = MatchGroup(control + position, h2);
+
+			for (auto match = masks.match; match != 0; match &= match - 1)
+			{
+				const auto index = (position + std::countr_zero(match)) & Mask();
+				if (KeyEqual()(elements[index].Key, key))
+				{
+					return index;
+				}
+			}
+
+			// The key would sit before the first empty slot after its home, so an empty slot means it isn't here
+			if (masks.empty != 0)
+			{
+				return NotFound;
+			}
+
+			position = (position + GroupWidth) & Mask();
+		}
+	}
+
+	std::size_t FindEmptyIndex(std::uint64_t hash) const
+	{
+		auto position = static_cast<std::size_t>(H1(hash)) & Mask();
+
+		while (true)
+		{
+			const auto empty = MatchGroup(control + position, 0).empty;
+			if (empty != 0)
+			{
+				return (position + std::countr_zero(empty)) & Mask();
+			}
+
+			position = (position + GroupWidth) & Mask();
+		}
+	}
+
+	void Rehash(std::size_t newCapacity)
+	{
+		auto oldElements = elements;
+		auto oldControl = control;
+		auto oldCapacity = capacity;
+
+		elements = std::allocator<ElementType>().allocate(newCapacity);
+		control = new std::uint8_t[newCapacity + GroupWidth];
+		std::memset(control, EmptyControl, newCapacity + GroupWidth);
+		capacity = newCapacity;
+
+		for (std::size_t i = 0; i < oldCapacity; i++)
+		{
+			if (oldControl[i] != EmptyControl)
+			{
+				const auto hash = Hash(oldElements[i].Key);
+				const auto index = FindEmptyIndex(hash);
+				new (&elements[index]) ElementType(std::move(oldElements[i]));
+				oldElements[i].~ElementType();
+				SetControl(index, H2(hash));
+			}
+		}
+
+		if (oldCapacity != 0)
+		{
+			std::allocator<ElementType>().deallocate(oldElements, oldCapacity);
+			delete[] oldControl;
+		}
+	}
+
+	void Release()
+	{
+		if (capacity == 0)
+		{
+			return;
+		}
+
+		for (std::size_t i = 0; i < capacity; i++)
+		{
+			if (control[i] != EmptyControl)
+			{
+				elements[i].~ElementType();
+			}
+		}
+
+		std::allocator<ElementType>().deallocate(elements, capacity);
+		delete[] control;
+	}
+
+	ElementType* elements = nullptr;
+	std::uint8_t* control = nullptr;
+	std::size_t capacity = 0;
+	std::size_t count = 0;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+/*
+ * Half and BFloat16 - floating point numbers in 16 bits, for storing lots of values in half the memory
+ *
+ * Both keep the layout of a float (sign, exponent, mantissa), they just give up different bits:
+ *
+ *                  sign    exponent    mantissa    range               precision
+ *      float       1       8           23          +-3.4 * 10^38       about 7 digits
+ *      Half        1       5           10          +-65504             about 3 digits (2048 + 1 is still 2048)
+ *      BFloat16    1       8           7           +-3.4 * 10^38       about 2 digits (256 + 1 is still 256)
+ *
+ * Half is the IEEE 754 binary16 format that GPUs use for textures and vertex data. BFloat16 is a float with the
+ * lower 16 bits cut off, so it covers everything a float does, just roughly.
+ *
+ * They are storage types: the math happens in float, and only the results are stored in 16 bits.
+ * Converting rounds to the nearest value (halfway to the even one), the same way the F16C instructions do,
+ * so the bulk functions in NumericKernels.h give the very same bits with or without SIMD.
+ *
+ *      auto stored = Half::FromFloat(1.0f / 3.0f);
+ *      float value = stored.ToFloat();    // 0.333251953125
+ */
+
+#include <bit>
+#include <cstdint>
+
+namespace Detail
+{
+	constexpr std::uint16_t FloatToHalfBits(float value)
+	{
+		const auto bits = std::bit_cast<std::uint32_t>(value);
+		const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+		const auto magnitude = bits & 0x7FFFFFFFu;
+
+		// NaN stays NaN: quiet, with as much of the payload as fits
+		if (magnitude > 0x7F800000u)
+		{
+			return static_cast<std::uint16_t>(sign | 0x7E00u | ((magnitude >> 13) & 0x03FFu));
+		}
+
+		// 65520 and above round to infinity
+		if (magnitude >= 0x477FF000u)
+		{
+			return static_cast<std::uint16_t>(sign | 0x7C00u);
+		}
+
+		// Below 2^-14 Half has no implicit leading 1 (subnormal), the mantissa is shifted right by the missing exponent
+		if (magnitude < 0x38800000u)
+		{
+			if (magnitude <= 0x33000000u)
+			{
+				return sign;
+			}
+			const auto exponent = magnitude >> 23;
+			const auto mantissa = (magnitude & 0x007FFFFFu) | 0x00800000u;
+			const auto shift = 126 - exponent;
+
+			auto result = mantissa >> shift;
+			const auto rest = mantissa & ((1u << shift) - 1);
+			const auto halfway = 1u << (shift - 1);
+			if (rest > halfway || (rest == halfway && (result & 1) != 0))
+			{
+				result++;
+			}
+			return static_cast<std::uint16_t>(sign | result);
+		}
+
+		// A carry out of the mantissa moves into the exponent, which is exactly right
+		auto result = (((magnitude >> 23) - 112) << 10) | ((magnitude >> 13) & 0x03FFu);
+		const auto rest = magnitude & 0x1FFFu;
+		if (rest > 0x1000u || (rest == 0x1000u && (result & 1) != 0))
+		{
+			result++;
+		}
+		return static_cast<std::uint16_t>(sign | result);
+	}
+
+	constexpr float HalfBitsToFloat(std::uint16_t half)
+	{
+		const auto sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+		const auto exponent = (half >> 10) & 0x1Fu;
+		auto mantissa = static_cast<std::uint32_t>(half & 0x03FFu);
+
+		if (exponent == 0x1F)
+		{
+			// Infinity, or a NaN that comes out quiet
+			return std::bit_cast<float>(sign | 0x7F800000u | (mantissa != 0 ? 0x00400000u | (mantissa << 13) : 0));
+		}
+		if (exponent == 0)
+		{
+			if (mantissa == 0)
+			{
+				return std::bit_cast<float>(sign);
+			}
+
+			// Subnormal, every Half is a normal float so shift until the leading 1 is in place
+			std::uint32_t floatExponent = 113;
+			while ((mantissa & 0x0400u) == 0)
+			{
+				mantissa <<= 1;
+				floatExponent--;
+			}
+			return std::bit_cast<float>(sign | (floatExponent << 23) | ((mantissa & 0x03FFu) << 13));
+		}
+		return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+
+	constexpr std::uint16_t FloatToBFloat16Bits(float value)
+	{
+		const auto bits = std::bit_cast<std::uint32_t>(value);
+		if ((bits & 0x7FFFFFFFu) > 0x7F800000u)
+		{
+			return static_cast<std::uint16_t>((bits >> 16) | 0x0040u);
+		}
+
+		// Adding just under half of the cut off part (plus one if the kept part is odd) rounds halfway to even
+		return static_cast<std::uint16_t>((bits + 0x7FFFu + ((bits >> 16) & 1)) >> 16);
+	}
+
+	constexpr float BFloat16BitsToFloat(std::uint16_t value)
+	{
+		return std::bit_cast<float>(static_cast<std::uint32_t>(value) << 16);
+	}
+}
+
+struct Half
+{
+	std::uint16_t bits = 0;
+
+	static constexpr Half FromFloat(float value) { return { Detail::FloatToHalfBits(value) }; }
+	constexpr float ToFloat() const { return Detail::HalfBitsToFloat(bits); }
+
+	// Compares the bits, so unlike with float a NaN equals itself and 0 doesn't equal -0
+	constexpr bool operator==(const Half&) const = default;
+};
+
+struct BFloat16
+{
+	std::uint16_t bits = 0;
+
+	static constexpr BFloat16 FromFloat(float value) { return { Detail::FloatToBFloat16Bits(value) }; }
+	constexpr float ToFloat() const { return Detail::BFloat16BitsToFloat(bits); }
+
+	constexpr bool operator==(const BFloat16&) const = default;
+};
@@ -0,0 +1,109 @@
+#include "InputDispatcher.h"
+#include <algorithm>
+#include <chrono>
+
+std::uint64_t InputDispatcher::NowNanoseconds()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void InputDispatcher::BindAction(std::string_view name, InputEventType type, std::function<void()> callback)
+{
+    auto& binding = actions[InternedName(name)];
+    if (type == InputEventType::Released)
+    {
+        binding.released.push_back(std::move(callback));
+    }
+    else
+    {
+        binding.pressed.push_back(std::move(callback));
+    }
+}
+
+void InputDispatcher::BindAxis(std::string_view name, std::function<void(float)> callback, AxisCoalesce coalesce)
+{
+    auto& binding = axes[InternedName(name)];
+    binding.callbacks.push_back(std::move(callback));
+    binding.coalesce = coalesce;
+}
+
+bool InputDispatcher::PostAction(InternedName binding, bool pressed)
+{
+    return queue.TryPush({ binding, pressed ? InputEventType::Pressed : InputEventType::Released, pressed ? 1.0f : 0.0f, NowNanoseconds() });
+}
+
+bool InputDispatcher::PostAxis(InternedName binding, float value)
+{
+    return queue.TryPush({ binding, InputEventType::Axis, value, NowNanoseconds() });
+}
+
+InputDispatchStats InputDispatcher::Dispatch()
+{
+    InputDispatchStats stats;
+
+    // Read the clock after the event is applied, so slow callbacks show up as latency of the events behind them
+    const auto addLatency = [&stats](std::uint64_t timestamp, std::uint64_t now)
+    {
+        const auto latency = now > timestamp ? now - timestamp : 0;
+        stats.totalLatencyNanoseconds += latency;
+        stats.maxLatencyNanoseconds = std::max(stats.maxLatencyNanoseconds, latency);
+    };
+
+    // Never take more than one queue's worth, otherwise a fast input thread could keep us in here forever
+    InputEvent event;
+    while (stats.events < QueueCapacity && queue.TryPop(event))
+    {
+        stats.events++;
+
+        if (event.type == InputEventType::Axis)
+        {
+            auto axis = axes.Find(event.binding);
+            if (axis == nullptr)
+            {
+                addLatency(event.timestampNanoseconds, NowNanoseconds());
+                continue;
+            }
+
+            if (!axis->hasPendingValue)
+            {
+                axis->hasPendingValue = true;
+                axis->pendingValue = 0.0f;
+                pendingAxes.push_back(axis);
+            }
+
+            axis->pendingValue = axis->coalesce == AxisCoalesce::Sum ? axis->pendingValue + event.value : event.value;
+            axis->pendingTimestamps.push_back(event.timestampNanoseconds);
+            continue;
+        }
+
+        auto action = actions.Find(event.binding);
+        if (action != nullptr)
+        {
+            for (auto& callback : event.type == InputEventType::Pressed ? action->pressed : action->released)
+            {
+                callback();
+            }
+        }
+        addLatency(event.timestampNanoseconds, NowNanoseconds());
+    }
+
+    // The axis map doesn't change while dispatching, so the pointers collected above are still valid
+    for (auto axis : pendingAxes)
+    {
+        for (auto& callback : axis->callbacks)
+        {
+            callback(axis->pendingValue);
+        }
+        axis->hasPendingValue = false;
+
+        const auto now = NowNanoseconds();
+        for (auto timestamp : axis->pendingTimestamps)
+        {
+            addLatency(timestamp, now);
+        }
+        axis->pendingTimestamps.clear();
+    }
+    pendingAxes.clear();
+
+    return stats;
+}
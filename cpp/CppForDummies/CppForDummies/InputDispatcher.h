@@ -0,0 +1,113 @@
+#pragma once
+
+/*
+ * InputDispatcher - input bindings that can be fed from another thread
+ *
+ * In ACppProjectCharacter::SetupPlayerInputComponent, every input calls its bound function right away.
+ * Here, input can instead be sampled on its own thread (as often as the device allows) and posted as events,
+ * and the game thread applies all events that arrived since the last frame in one go with Dispatch().
+ *
+ * Bind everything before anything gets posted, the bindings themselves are only for the game thread.
+ *
+ *      dispatcher.BindAction("Jump", InputEventType::Pressed, [&] { character.Jump(); });
+ *      dispatcher.BindAxis("MoveForward", [&](float value) { character.MoveForward(value); });
+ *
+ *      // Input thread
+ *      dispatcher.PostAxis(moveForwardName, 1.0f);
+ *
+ *      // Game thread, once per frame
+ *      dispatcher.Dispatch();
+ */
+
+#include "EventQueue.h"
+#include "FlatHashMap.h"
+#include "InternedName.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+enum class InputEventType : std::uint8_t
+{
+	Pressed,
+	Released,
+	Axis
+};
+
+// What to do when an axis receives several values within one frame
+enum class AxisCoalesce : std::uint8_t
+{
+	// Use the newest value, for things like analog sticks (MoveForward, TurnRate)
+	Latest,
+
+	// Add the values up, for deltas like mouse movement (Turn, LookUp)
+	Sum
+};
+
+struct InputEvent
+{
+	InternedName binding;
+	InputEventType type;
+	float value;
+
+	// When the input was sampled, see InputDispatcher::NowNanoseconds()
+	std::uint64_t timestampNanoseconds;
+};
+
+struct InputDispatchStats
+{
+	std::size_t events = 0;
+
+	// Time from sampling an event until its callbacks have run (or it was dropped for having no binding)
+	std::uint64_t totalLatencyNanoseconds = 0;
+	std::uint64_t maxLatencyNanoseconds = 0;
+};
+
+class InputDispatcher
+{
+public:
+	static constexpr std::size_t QueueCapacity = 4096;
+
+	static std::uint64_t NowNanoseconds();
+
+	void BindAction(std::string_view name, InputEventType type, std::function<void()> callback);
+	void BindAxis(std::string_view name, std::function<void(float)> callback, AxisCoalesce coalesce = AxisCoalesce::Latest);
+
+	// Can be called from any thread. Returns false if the queue is full and the event was dropped.
+	bool PostAction(InternedName binding, bool pressed);
+	bool PostAxis(InternedName binding, float value);
+
+	/*
+	 * Game thread only
+	 *
+	 * Actions are applied in the order they arrived.
+	 * Afterwards every axis that received values is called once with the coalesced value.
+	 * Axes that received nothing are not called.
+	 */
+	InputDispatchStats Dispatch();
+
+private:
+	struct ActionBinding
+	{
+		std::vector<std::function<void()>> pressed;
+		std::vector<std::function<void()>> released;
+	};
+
+	struct AxisBinding
+	{
+		std::vector<std::function<void(float)>> callbacks;
+		AxisCoalesce coalesce = AxisCoalesce::Latest;
+		float pendingValue = 0.0f;
+		bool hasPendingValue = false;
+
+		// The coalesced events are applied together, their latency is counted once the callbacks have run
+		std::vector<std::uint64_t> pendingTimestamps;
+	};
+
+	FlatHashMap<InternedName, ActionBinding> actions;
+	FlatHashMap<InternedName, AxisBinding> axes;
+	std::vector<AxisBinding*> pendingAxes;
+
+	MpscQueue<InputEvent, QueueCapacity> queue;
+};
@@ -0,0 +1,128 @@
+#include "InternedName.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+/*
+ * The intern table is an open-addressing hash table of pointers to entries.
+ *
+ * It's lock-free: a new entry is published with a single compare-exchange on an empty slot.
+ * If another thread wins the race for that slot we check whether it inserted the same text,
+ * and otherwise keep probing. Entries are never removed, so a pointer that was read once stays valid forever.
+ *
+ * The id of a name is its slot index. Slot 0 is reserved for 'None'.
+ */
+
+namespace
+{
+    struct Entry
+    {
+        std::uint64_t hash;
+        std::uint32_t length;
+        char text[1];
+    };
+
+    constexpr std::uint32_t SlotMask = InternedName::MaxNames - 1;
+
+    std::atomic<Entry*> slots[InternedName::MaxNames];
+    std::atomic<std::uint32_t> nameCount{ 1 };
+
+    // FNV-1a, simple and good enough for short names
+    std::uint64_t HashText(std::string_view text)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (auto character : text)
+        {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool Matches(const Entry* entry, std::uint64_t hash, std::string_view text)
+    {
+        return entry->hash == hash && entry->length == text.size() && std::memcmp(entry->text, text.data(), text.size()) == 0;
+    }
+
+    Entry* CreateEntry(std::uint64_t hash, std::string_view text)
+    {
+        auto entry = static_cast<Entry*>(std::malloc(sizeof(Entry) + text.size()));
+        if (entry == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        entry->hash = hash;
+        entry->length = static_cast<std::uint32_t>(text.size());
+        std::memcpy(entry->text, text.data(), text.size());
+        entry->text[text.size()] = '\0';
+        return entry;
+    }
+}
+
+InternedName::InternedName(std::string_view text) : id(0)
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    const auto hash = HashText(text);
+    Entry* created = nullptr;
+
+    for (std::uint32_t probe = 0; probe < MaxNames; probe++)
+    {
+        const auto slot = static_cast<std::uint32_t>(hash + probe) & SlotMask;
+        if (slot == 0)
+        {
+            continue;
+        }
+
+        auto entry = slots[slot].load(std::memory_order_acquire);
+        if (entry == nullptr)
+        {
+            // Keep the table at most 3/4 full, otherwise probing gets slow
+            if (nameCount.load(std::memory_order_relaxed) >= MaxNames / 4 * 3)
+            {
+                std::free(created);
+                throw std::length_error("InternedName table is full");
+            }
+
+            if (created == nullptr)
+            {
+                created = CreateEntry(hash, text);
+            }
+
+            if (slots[slot].compare_exchange_strong(entry, created, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                nameCount.fetch_add(1, std::memory_order_relaxed);
+                id = slot;
+                return;
+            }
+
+            // Lost the race, 'entry' now holds what the other thread inserted
+        }
+
+        if (Matches(entry, hash, text))
+        {
+            std::free(created);
+            id = slot;
+            return;
+        }
+    }
+
+    std::free(created);
+    throw std::length_error("InternedName table is full");
+}
+
+std::string_view InternedName::ToStringView() const
+{
+    if (id == 0)
+    {
+        return {};
+    }
+
+    auto entry = slots[id].load(std::memory_order_acquire);
+    return std::string_view(entry->text, entry->length);
+}
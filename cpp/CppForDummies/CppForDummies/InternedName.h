@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * InternedName - a stand-in for UE4's FName
+ *
+ * Every distinct piece of text is stored exactly once in a global table, and an InternedName is just the
+ * 32-bit number of its slot in that table. Comparing or hashing two names therefore only compares two numbers,
+ * no matter how long the text is.
+ *
+ * Creating a name has to look the text up in the table, so create names once (binding names, asset paths)
+ * and keep them around, instead of creating them from strings in hot code.
+ *
+ * Names are case-sensitive ("Jump" and "jump" are different names), unlike FName.
+ * The table never shrinks and holds at most MaxNames different names.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+class InternedName
+{
+public:
+	static constexpr std::uint32_t MaxNames = 1u << 18;
+
+	// The 'None' name, with id 0 and empty text
+	InternedName() : id(0) {}
+
+	explicit InternedName(std::string_view text);
+
+	std::uint32_t GetId() const { return id; }
+	bool IsNone() const { return id == 0; }
+
+	std::string_view ToStringView() const;
+
+	bool operator==(InternedName other) const { return id == other.id; }
+	bool operator!=(InternedName other) const { return id != other.id; }
+
+	// Orders by id, which is fast but not alphabetical
+	bool operator<(InternedName other) const { return id < other.id; }
+
+	// Ids are slot indices in the name table, so they're already spread out, but they only have 18 bits.
+	// FlatHashMap uses the low 7 bits of a hash as the control byte and the bits above it for the bucket,
+	// which would leave just 11 bits (2048 buckets) to pick from, so the id gets mixed over all 64 bits first
+	std::size_t GetHash() const { return static_cast<std::size_t>(id * 0x9E3779B97F4A7C15ull); }
+
+private:
+	std::uint32_t id;
+};
+
+template <>
+struct std::hash<InternedName>
+{
+	std::size_t operator()(InternedName name) const noexcept { return name.GetHash(); }
+};
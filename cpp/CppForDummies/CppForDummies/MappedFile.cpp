@@ -0,0 +1,119 @@
+#include "MappedFile.h"
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#else
+#define MAPPED_FILE_MMAP 0
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        buffer = std::move(other.buffer);
+        data = other.mapped ? other.data : buffer.data();
+        size = other.size;
+        open = other.open;
+        mapped = other.mapped;
+
+        other.data = nullptr;
+        other.size = 0;
+        other.open = false;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+#if MAPPED_FILE_MMAP
+    const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // mmap refuses zero-length mappings
+    if (status.st_size > 0)
+    {
+        auto* address = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED)
+        {
+            data = static_cast<const std::uint8_t*>(address);
+            size = static_cast<std::size_t>(status.st_size);
+            mapped = true;
+        }
+    }
+
+    // The mapping keeps the file alive by itself
+    ::close(fd);
+
+    if (mapped || status.st_size == 0)
+    {
+        open = true;
+        return true;
+    }
+#endif
+
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream)
+    {
+        return false;
+    }
+
+    buffer.resize(static_cast<std::size_t>(stream.tellg()));
+    stream.seekg(0);
+    if (!stream.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size())))
+    {
+        buffer.clear();
+        return false;
+    }
+
+    data = buffer.data();
+    size = buffer.size();
+    open = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#if MAPPED_FILE_MMAP
+    if (mapped)
+    {
+        munmap(const_cast<std::uint8_t*>(data), size);
+    }
+#endif
+
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+    open = false;
+    mapped = false;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+ * MappedFile - reading a whole file without copying it
+ *
+ * Reading a file with std::ifstream copies its bytes from the operating system's cache into our own buffer.
+ * Memory-mapping it instead makes the file show up directly in our address space: the operating system loads
+ * pages as we touch them, and the parts we never look at are never read at all.
+ *
+ * On Linux (and other POSIX systems) this uses mmap. Everywhere else the file is simply read into memory,
+ * so the same code works, just a bit slower.
+ *
+ *      MappedFile file;
+ *      if (file.Open("Content/ThirdPersonCPP/Blueprints/ThirdPersonCharacter.uasset"))
+ *      {
+ *          const auto* bytes = file.GetData();
+ *      }
+ *
+ * The data stays valid until the MappedFile is closed or destroyed. Don't change the file while it's mapped.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// Returns false if the file can't be opened, empty files open fine and have no data
+	bool Open(const std::string& path);
+	void Close();
+
+	const std::uint8_t* GetData() const { return data; }
+	std::size_t GetSize() const { return size; }
+	bool IsOpen() const { return open; }
+
+private:
+	const std::uint8_t* data = nullptr;
+	std::size_t size = 0;
+	bool open = false;
+	bool mapped = false;
+
+	// Only used when the file couldn't be mapped
+	std::vector<std::uint8_t> buffer;
+};
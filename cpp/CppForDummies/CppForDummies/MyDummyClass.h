@@ -16,7 +16,8 @@ public:
 	MyDummyClass();
 
 	// Destructor (noted by prefixing tilde ~) - happens when the class is 'destroyed'
-	~MyDummyClass();
+	// Classes with virtual functions should have a virtual destructor, so deleting a child class through a parent pointer destroys it properly
+	virtual ~MyDummyClass();
 
 	int num;
 
@@ -34,5 +35,8 @@ protected:
 	// Protected members are like private, but they are accessable by those who inherit the class
 
 	int protectedNum;
+
+	// A friend class can use the private and protected members too, DummyRecord (see DummyArchive.h) saves and loads them
+	friend struct DummyRecord;
 };
 
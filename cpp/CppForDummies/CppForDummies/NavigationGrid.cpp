@@ -0,0 +1,248 @@
+#include "NavigationGrid.h"
+#include <algorithm>
+#include <cmath>
+
+/*
+ * HeightField
+ */
+
+HeightField::HeightField(int width, int height, float cellSize)
+    : width(width), height(height), cellSize(cellSize),
+      floors(static_cast<std::size_t>(width) * height, 0.0f), ceilings(static_cast<std::size_t>(width) * height, OpenSky)
+{
+}
+
+/*
+ * NavigationGrid
+ */
+
+NavigationGrid::NavigationGrid(const HeightField& heightField, const AgentSettings& agent, int clusterSize)
+    : width(heightField.GetWidth()), height(heightField.GetHeight()), cellSize(heightField.GetCellSize()),
+      clusterSize(clusterSize), clusterColumns((width + clusterSize - 1) / clusterSize), agent(agent),
+      standable(static_cast<std::size_t>(width) * height, 0), walkable(static_cast<std::size_t>(width) * height, 0)
+{
+    // Every cell whose center is within the radius (plus half a cell, to reach the cell's edge) of the capsule's cell
+    const auto reach = agent.capsuleRadius / cellSize + 0.5f;
+    const auto range = static_cast<int>(std::ceil(reach));
+    for (auto dy = -range; dy <= range; dy++)
+    {
+        for (auto dx = -range; dx <= range; dx++)
+        {
+            if ((dx != 0 || dy != 0) && static_cast<float>(dx * dx + dy * dy) <= reach * reach)
+            {
+                radiusOffsets.push_back({ dx, dy });
+                changeReach = std::max(changeReach, dx + 1);
+            }
+        }
+    }
+
+    ComputeStandable(heightField, 0, 0, width - 1, height - 1);
+    ComputeWalkable(0, 0, width - 1, height - 1);
+    BuildRegions();
+}
+
+void NavigationGrid::Rebuild(const HeightField& heightField, GridPoint min, GridPoint max)
+{
+    // A cell's slope and steps depend on its neighbours, and walkability on everything within the radius
+    ComputeStandable(heightField, std::max(min.x - 1, 0), std::max(min.y - 1, 0), std::min(max.x + 1, width - 1), std::min(max.y + 1, height - 1));
+    ComputeWalkable(std::max(min.x - changeReach, 0), std::max(min.y - changeReach, 0), std::min(max.x + changeReach, width - 1), std::min(max.y + changeReach, height - 1));
+    BuildRegions();
+}
+
+bool NavigationGrid::IsStandable(const HeightField& heightField, int x, int y) const
+{
+    const auto floor = heightField.GetFloor(x, y);
+    if (heightField.GetCeiling(x, y) - floor < agent.capsuleHalfHeight * 2.0f)
+    {
+        return false;
+    }
+
+    const auto maxSlope = std::tan(agent.walkableFloorAngle * 3.14159265f / 180.0f);
+
+    /*
+     * The slope along an axis is the gentler of the two sides. On stairs one side of every cell is flat,
+     * only on a real slope are both sides steep.
+     */
+    const int axes[2][2] = { { 1, 0 }, { 0, 1 } };
+    for (const auto& axis : axes)
+    {
+        auto gentlest = std::numeric_limits<float>::max();
+        for (auto side : { -1, 1 })
+        {
+            const auto nx = x + axis[0] * side;
+            const auto ny = y + axis[1] * side;
+            if (IsInside(nx, ny))
+            {
+                gentlest = std::min(gentlest, std::abs(heightField.GetFloor(nx, ny) - floor));
+            }
+        }
+        if (gentlest != std::numeric_limits<float>::max() && gentlest / cellSize > maxSlope)
+        {
+            return false;
+        }
+    }
+
+    // Every neighbour must be reachable by a step or by walking up the slope
+    for (auto dy = -1; dy <= 1; dy++)
+    {
+        for (auto dx = -1; dx <= 1; dx++)
+        {
+            if ((dx == 0 && dy == 0) || !IsInside(x + dx, y + dy))
+            {
+                continue;
+            }
+
+            const auto distance = (dx != 0 && dy != 0 ? 1.41421356f : 1.0f) * cellSize;
+            const auto climb = std::max(agent.maxStepHeight, maxSlope * distance);
+            if (std::abs(heightField.GetFloor(x + dx, y + dy) - floor) > climb)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void NavigationGrid::ComputeStandable(const HeightField& heightField, int minX, int minY, int maxX, int maxY)
+{
+    for (auto y = minY; y <= maxY; y++)
+    {
+        for (auto x = minX; x <= maxX; x++)
+        {
+            standable[Index(x, y)] = IsStandable(heightField, x, y) ? 1 : 0;
+        }
+    }
+}
+
+void NavigationGrid::ComputeWalkable(int minX, int minY, int maxX, int maxY)
+{
+    for (auto y = minY; y <= maxY; y++)
+    {
+        for (auto x = minX; x <= maxX; x++)
+        {
+            auto clear = standable[Index(x, y)] != 0;
+
+            // The edge of the map counts as a wall
+            for (std::size_t i = 0; clear && i < radiusOffsets.size(); i++)
+            {
+                const auto nx = x + radiusOffsets[i].x;
+                const auto ny = y + radiusOffsets[i].y;
+                clear = IsInside(nx, ny) && standable[Index(nx, ny)] != 0;
+            }
+
+            walkable[Index(x, y)] = clear ? 1 : 0;
+        }
+    }
+}
+
+void NavigationGrid::BuildRegions()
+{
+    regionOfCell.assign(static_cast<std::size_t>(width) * height, NoRegion);
+    regions.clear();
+
+    // Flood fill the walkable cells of every cluster. Diagonal moves never cut corners, so 4 neighbours are enough.
+    std::vector<GridPoint> stack;
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            if (!IsWalkable(x, y) || regionOfCell[Index(x, y)] != NoRegion)
+            {
+                continue;
+            }
+
+            const auto cluster = GetCluster(x, y);
+            const auto id = static_cast<std::int32_t>(regions.size());
+            const auto clusterX = x / clusterSize;
+            const auto clusterY = y / clusterSize;
+
+            double sumX = 0.0;
+            double sumY = 0.0;
+            std::size_t cells = 0;
+
+            regionOfCell[Index(x, y)] = id;
+            stack.push_back({ x, y });
+            while (!stack.empty())
+            {
+                const auto cell = stack.back();
+                stack.pop_back();
+                sumX += cell.x;
+                sumY += cell.y;
+                cells++;
+
+                const GridPoint neighbours[] = { { cell.x + 1, cell.y }, { cell.x - 1, cell.y }, { cell.x, cell.y + 1 }, { cell.x, cell.y - 1 } };
+                for (const auto& neighbour : neighbours)
+                {
+                    if (IsWalkable(neighbour.x, neighbour.y) && neighbour.x / clusterSize == clusterX && neighbour.y / clusterSize == clusterY
+                        && regionOfCell[Index(neighbour.x, neighbour.y)] == NoRegion)
+                    {
+                        regionOfCell[Index(neighbour.x, neighbour.y)] = id;
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+
+            regions.push_back({ cluster, static_cast<float>(sumX / cells), static_cast<float>(sumY / cells), -1, {} });
+        }
+    }
+
+    // Link regions that touch across a cluster border
+    const auto link = [this](std::int32_t a, std::int32_t b)
+    {
+        auto& neighbours = regions[a].neighbours;
+        if (std::find(neighbours.begin(), neighbours.end(), b) == neighbours.end())
+        {
+            neighbours.push_back(b);
+            regions[b].neighbours.push_back(a);
+        }
+    };
+
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            const auto region = regionOfCell[Index(x, y)];
+            if (region == NoRegion)
+            {
+                continue;
+            }
+            if ((x + 1) % clusterSize == 0 && x + 1 < width && regionOfCell[Index(x + 1, y)] != NoRegion)
+            {
+                link(region, regionOfCell[Index(x + 1, y)]);
+            }
+            if ((y + 1) % clusterSize == 0 && y + 1 < height && regionOfCell[Index(x, y + 1)] != NoRegion)
+            {
+                link(region, regionOfCell[Index(x, y + 1)]);
+            }
+        }
+    }
+
+    // Components are the groups of linked regions
+    auto component = 0;
+    std::vector<std::int32_t> pending;
+    for (std::size_t start = 0; start < regions.size(); start++)
+    {
+        if (regions[start].component != -1)
+        {
+            continue;
+        }
+
+        regions[start].component = component;
+        pending.push_back(static_cast<std::int32_t>(start));
+        while (!pending.empty())
+        {
+            const auto region = pending.back();
+            pending.pop_back();
+            for (auto neighbour : regions[region].neighbours)
+            {
+                if (regions[neighbour].component == -1)
+                {
+                    regions[neighbour].component = component;
+                    pending.push_back(neighbour);
+                }
+            }
+        }
+        component++;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+ * NavigationGrid - where a character can walk, on a grid of cells
+ *
+ * The level (TemplateFloor, ramps, stairs, bumps) is described by a HeightField: the floor height of every cell,
+ * and how high the space above it is. A cell is walkable for a character when:
+ *
+ *      the capsule fits under the ceiling            2 * CapsuleHalfHeight of headroom
+ *      the floor isn't too steep                     WalkableFloorAngle, like UCharacterMovementComponent
+ *      every neighbour can be stepped onto           MaxStepHeight, so stairs work but walls don't
+ *      nothing unwalkable is closer than the radius  CapsuleRadius, so the capsule doesn't clip into walls
+ *
+ * It's 2.5D: every cell has one floor, so there are no bridges over walkable ground.
+ *
+ * For long paths the grid is also split into clusters (squares of cells). Inside every cluster, the walkable cells
+ * that are connected form a region, and regions that touch across cluster borders are linked. PathFinder first
+ * finds a path through these few regions and then only searches cells inside them (hierarchical pathfinding).
+ * Regions are also grouped into components: if start and goal are in different components, there is no path at all.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Defaults match ACppProjectCharacter's capsule (InitCapsuleSize(42, 96)) and UCharacterMovementComponent
+struct AgentSettings
+{
+	float capsuleRadius = 42.0f;
+	float capsuleHalfHeight = 96.0f;
+	float maxStepHeight = 45.0f;
+	float walkableFloorAngle = 44.765f;
+};
+
+class HeightField
+{
+public:
+	static constexpr float OpenSky = std::numeric_limits<float>::max();
+
+	HeightField(int width, int height, float cellSize);
+
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+	float GetCellSize() const { return cellSize; }
+
+	float GetFloor(int x, int y) const { return floors[Index(x, y)]; }
+	float GetCeiling(int x, int y) const { return ceilings[Index(x, y)]; }
+
+	void SetFloor(int x, int y, float floor) { floors[Index(x, y)] = floor; }
+	void SetCeiling(int x, int y, float ceiling) { ceilings[Index(x, y)] = ceiling; }
+
+private:
+	std::size_t Index(int x, int y) const { return static_cast<std::size_t>(y) * width + x; }
+
+	int width;
+	int height;
+	float cellSize;
+	std::vector<float> floors;
+	std::vector<float> ceilings;
+};
+
+struct GridPoint
+{
+	int x;
+	int y;
+
+	bool operator==(const GridPoint& other) const { return x == other.x && y == other.y; }
+	bool operator!=(const GridPoint& other) const { return !(*this == other); }
+};
+
+class NavigationGrid
+{
+public:
+	static constexpr std::int32_t NoRegion = -1;
+
+	struct Region
+	{
+		int cluster;
+		float centerX;
+		float centerY;
+		int component;
+		std::vector<std::int32_t> neighbours;
+	};
+
+	NavigationGrid(const HeightField& heightField, const AgentSettings& agent, int clusterSize = 32);
+
+	/*
+	 * The height field changed between min and max (inclusive), for example a door closed
+	 * Only cells near the change are recomputed, the regions are rebuilt since their numbering changes
+	 */
+	void Rebuild(const HeightField& heightField, GridPoint min, GridPoint max);
+
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+	float GetCellSize() const { return cellSize; }
+	int GetClusterSize() const { return clusterSize; }
+	int GetClusterColumns() const { return clusterColumns; }
+
+	// How many cells past a change in the height field walkability can change
+	int GetChangeReach() const { return changeReach; }
+
+	bool IsInside(int x, int y) const { return x >= 0 && y >= 0 && x < width && y < height; }
+	bool IsWalkable(int x, int y) const { return IsInside(x, y) && walkable[Index(x, y)] != 0; }
+
+	int GetCluster(int x, int y) const { return (y / clusterSize) * clusterColumns + x / clusterSize; }
+	std::int32_t GetRegion(int x, int y) const { return regionOfCell[Index(x, y)]; }
+	const std::vector<Region>& GetRegions() const { return regions; }
+
+	std::size_t Index(int x, int y) const { return static_cast<std::size_t>(y) * width + x; }
+
+private:
+	bool IsStandable(const HeightField& heightField, int x, int y) const;
+	void ComputeStandable(const HeightField& heightField, int minX, int minY, int maxX, int maxY);
+	void ComputeWalkable(int minX, int minY, int maxX, int maxY);
+	void BuildRegions();
+
+	int width;
+	int height;
+	float cellSize;
+	int clusterSize;
+	int clusterColumns;
+	AgentSettings agent;
+
+	// Cells the capsule could stand on, before keeping its radius away from everything else
+	std::vector<std::uint8_t> standable;
+	std::vector<std::uint8_t> walkable;
+
+	// Cells a capsule standing on a cell overlaps, as offsets
+	std::vector<GridPoint> radiusOffsets;
+	int changeReach = 1;
+
+	std::vector<std::int32_t> regionOfCell;
+	std::vector<Region> regions;
+};
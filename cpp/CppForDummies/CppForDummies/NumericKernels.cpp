@@ -0,0 +1,377 @@
+#include "NumericKernels.h"
+#include <cstdint>
+
+/*
+ * The AVX2 and F16C versions are compiled into every x86 build and picked when the program starts, if the CPU has them.
+ * GCC and Clang need to be told that a function may use those instructions (the target attribute),
+ * MSVC allows the intrinsics anywhere. Every CPU with AVX2 also has F16C, so they're used together.
+ */
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define NUMERIC_KERNELS_AVX2 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NUMERIC_KERNELS_TARGET
+#else
+#define NUMERIC_KERNELS_TARGET __attribute__((target("avx2,f16c")))
+#endif
+#endif
+
+namespace
+{
+#if defined(NUMERIC_KERNELS_AVX2)
+    bool DetectAvx2()
+    {
+#if defined(__AVX2__) && defined(__F16C__)
+        return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+        int registers[4];
+        __cpuid(registers, 0);
+        if (registers[0] < 7)
+        {
+            return false;
+        }
+
+        // F16C, AVX and the operating system saving the AVX registers (OSXSAVE), then AVX2
+        __cpuid(registers, 1);
+        const auto features = registers[2];
+        if ((features & (1 << 29)) == 0 || (features & (1 << 28)) == 0 || (features & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+        {
+            return false;
+        }
+        __cpuidex(registers, 7, 0);
+        return (registers[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+    }
+
+    const bool UseAvx2 = DetectAvx2();
+
+    // 8 BFloat16 to float: the 16 bits become the upper half of a float
+    NUMERIC_KERNELS_TARGET inline __m256 LoadBFloat16(const BFloat16* values)
+    {
+        const auto bits = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16));
+    }
+
+    // The same rounding as Detail::FloatToBFloat16Bits, the results are in the low 16 bits of every lane
+    NUMERIC_KERNELS_TARGET inline __m256i RoundToBFloat16(__m256 values)
+    {
+        const auto bits = _mm256_castps_si256(values);
+        const auto odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+        const auto rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(_mm256_set1_epi32(0x7FFF), odd)), 16);
+        const auto quietNaN = _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x0040));
+        const auto isNaN = _mm256_cmpgt_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFFFF)), _mm256_set1_epi32(0x7F800000));
+        return _mm256_or_si256(_mm256_andnot_si256(isNaN, rounded), _mm256_and_si256(isNaN, quietNaN));
+    }
+
+    // 16 BFloat16 at once. Packing works within each 128 bit half, the permute puts the results back in order.
+    NUMERIC_KERNELS_TARGET inline void StoreBFloat16(BFloat16* out, __m256 first, __m256 second)
+    {
+        const auto packed = _mm256_packus_epi32(RoundToBFloat16(first), RoundToBFloat16(second));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(packed, 0b11011000));
+    }
+
+    // The same rounding as Fixed16 * Fixed16, for the 4 even and the 4 odd lanes separately
+    NUMERIC_KERNELS_TARGET inline __m256i MultiplyFixed16(__m256i a, __m256i b)
+    {
+        const auto half = _mm256_set1_epi64x(1 << 15);
+        const auto even = _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epi32(a, b), half), 16);
+        const auto odd = _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)), half), 16);
+
+        // Only the low 32 bits of every product are kept, so shifting in zeros instead of the sign doesn't matter
+        return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0b10101010);
+    }
+
+    /*
+     * Each of these does as many whole blocks as fit and returns how many values that was, the caller does the rest
+     */
+
+    NUMERIC_KERNELS_TARGET std::size_t ConvertToHalfAvx2(const float* values, Half* out, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const auto half = _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), half);
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t ConvertFromHalfAvx2(const Half* values, float* out, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i))));
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t ConvertToBFloat16Avx2(const float* values, BFloat16* out, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            StoreBFloat16(out + i, _mm256_loadu_ps(values + i), _mm256_loadu_ps(values + i + 8));
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t ConvertFromBFloat16Avx2(const BFloat16* values, float* out, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(out + i, LoadBFloat16(values + i));
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t ConvertToFixed16Avx2(const float* values, Fixed16* out, std::size_t count)
+    {
+        const auto scale = _mm256_set1_ps(static_cast<float>(Fixed16::One));
+        const auto limit = _mm256_set1_ps(2147483648.0f);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            // Scaling by a power of 2 is exact, the conversion rounds halfway to even like Fixed16::FromFloat
+            const auto scaled = _mm256_mul_ps(_mm256_loadu_ps(values + i), scale);
+            auto raw = _mm256_cvtps_epi32(scaled);
+
+            // Too small already gives INT_MIN, too big has to be clamped and NaN becomes 0
+            raw = _mm256_blendv_epi8(raw, _mm256_set1_epi32(INT32_MAX), _mm256_castps_si256(_mm256_cmp_ps(scaled, limit, _CMP_GE_OQ)));
+            raw = _mm256_and_si256(raw, _mm256_castps_si256(_mm256_cmp_ps(scaled, scaled, _CMP_ORD_Q)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), raw);
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t ConvertFromFixed16Avx2(const Fixed16* values, float* out, std::size_t count)
+    {
+        const auto scale = _mm256_set1_ps(1.0f / static_cast<float>(Fixed16::One));
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const auto raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(raw), scale));
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t IntegrateAvx2(Fixed16* positions, const Fixed16* velocities, Fixed16 deltaSeconds, std::size_t count)
+    {
+        const auto delta = _mm256_set1_epi32(deltaSeconds.GetRaw());
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            auto* position = reinterpret_cast<__m256i*>(positions + i);
+            const auto step = MultiplyFixed16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(velocities + i)), delta);
+            _mm256_storeu_si256(position, _mm256_add_epi32(_mm256_loadu_si256(position), step));
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t IntegrateAvx2(Half* positions, const Half* velocities, float deltaSeconds, std::size_t count)
+    {
+        const auto delta = _mm256_set1_ps(deltaSeconds);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            auto* position = reinterpret_cast<__m128i*>(positions + i);
+            const auto step = _mm256_mul_ps(_mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(velocities + i))), delta);
+            const auto moved = _mm256_add_ps(_mm256_cvtph_ps(_mm_loadu_si128(position)), step);
+            _mm_storeu_si128(position, _mm256_cvtps_ph(moved, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+        }
+        return i;
+    }
+
+    NUMERIC_KERNELS_TARGET std::size_t IntegrateAvx2(BFloat16* positions, const BFloat16* velocities, float deltaSeconds, std::size_t count)
+    {
+        const auto delta = _mm256_set1_ps(deltaSeconds);
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            const auto first = _mm256_add_ps(LoadBFloat16(positions + i), _mm256_mul_ps(LoadBFloat16(velocities + i), delta));
+            const auto second = _mm256_add_ps(LoadBFloat16(positions + i + 8), _mm256_mul_ps(LoadBFloat16(velocities + i + 8), delta));
+            StoreBFloat16(positions + i, first, second);
+        }
+        return i;
+    }
+#endif
+}
+
+bool HasSimdNumericKernels()
+{
+#if defined(NUMERIC_KERNELS_AVX2)
+    return UseAvx2;
+#else
+    return false;
+#endif
+}
+
+const char* GetNumericKernelPath()
+{
+    return HasSimdNumericKernels() ? "AVX2 + F16C" : "one at a time, no SIMD";
+}
+
+/*
+ * Conversions
+ */
+
+void ConvertToHalf(const float* values, Half* out, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = ConvertToHalfAvx2(values, out, count);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[i] = Half::FromFloat(values[i]);
+    }
+}
+
+void ConvertFromHalf(const Half* values, float* out, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = ConvertFromHalfAvx2(values, out, count);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[i] = values[i].ToFloat();
+    }
+}
+
+void ConvertToBFloat16(const float* values, BFloat16* out, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = ConvertToBFloat16Avx2(values, out, count);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[i] = BFloat16::FromFloat(values[i]);
+    }
+}
+
+void ConvertFromBFloat16(const BFloat16* values, float* out, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = ConvertFromBFloat16Avx2(values, out, count);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[i] = values[i].ToFloat();
+    }
+}
+
+void ConvertToFixed16(const float* values, Fixed16* out, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = ConvertToFixed16Avx2(values, out, count);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[i] = Fixed16::FromFloat(values[i]);
+    }
+}
+
+void ConvertFromFixed16(const Fixed16* values, float* out, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = ConvertFromFixed16Avx2(values, out, count);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[i] = values[i].ToFloat();
+    }
+}
+
+/*
+ * Integration
+ */
+
+void Integrate(Fixed16* positions, const Fixed16* velocities, Fixed16 deltaSeconds, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = IntegrateAvx2(positions, velocities, deltaSeconds, count);
+    }
+#endif
+    IntegrateScalar(positions + i, velocities + i, deltaSeconds, count - i);
+}
+
+void Integrate(Half* positions, const Half* velocities, float deltaSeconds, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = IntegrateAvx2(positions, velocities, deltaSeconds, count);
+    }
+#endif
+    IntegrateScalar(positions + i, velocities + i, deltaSeconds, count - i);
+}
+
+void Integrate(BFloat16* positions, const BFloat16* velocities, float deltaSeconds, std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(NUMERIC_KERNELS_AVX2)
+    if (UseAvx2)
+    {
+        i = IntegrateAvx2(positions, velocities, deltaSeconds, count);
+    }
+#endif
+    IntegrateScalar(positions + i, velocities + i, deltaSeconds, count - i);
+}
+
+void IntegrateScalar(Fixed16* positions, const Fixed16* velocities, Fixed16 deltaSeconds, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        positions[i] += velocities[i] * deltaSeconds;
+    }
+}
+
+void IntegrateScalar(Half* positions, const Half* velocities, float deltaSeconds, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto step = velocities[i].ToFloat() * deltaSeconds;
+        positions[i] = Half::FromFloat(positions[i].ToFloat() + step);
+    }
+}
+
+void IntegrateScalar(BFloat16* positions, const BFloat16* velocities, float deltaSeconds, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto step = velocities[i].ToFloat() * deltaSeconds;
+        positions[i] = BFloat16::FromFloat(positions[i].ToFloat() + step);
+    }
+}
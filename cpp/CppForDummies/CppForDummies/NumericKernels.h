@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * NumericKernels - converting and updating big arrays of Fixed16, Half and BFloat16 values with SIMD
+ *
+ * Converting one value at a time (see FixedPoint.h and HalfFloat.h) is fine for a few of them. For a whole simulation
+ * state these functions do 8 values per instruction: with AVX2 for Fixed16 and BFloat16, and with the F16C conversion
+ * instructions for Half. Whether the CPU has them is checked when the program starts, no compiler flags needed.
+ * Without them the same work is done one value at a time.
+ *
+ * Every function gives exactly the same bits as the one-at-a-time version, on every machine, with or without SIMD.
+ * The floating point ones multiply and add as two separate steps (never fused), so the rounding is always the same.
+ *
+ *      std::vector<Half> positions(count);
+ *      ConvertToHalf(floatPositions.data(), positions.data(), count);
+ *
+ *      // Every frame
+ *      Integrate(positions.data(), velocities.data(), deltaSeconds, count);
+ */
+
+#include "FixedPoint.h"
+#include "HalfFloat.h"
+#include <cstddef>
+
+// Whether the functions below use SIMD on this machine, and which instructions, like "AVX2 + F16C"
+bool HasSimdNumericKernels();
+const char* GetNumericKernelPath();
+
+void ConvertToHalf(const float* values, Half* out, std::size_t count);
+void ConvertFromHalf(const Half* values, float* out, std::size_t count);
+
+void ConvertToBFloat16(const float* values, BFloat16* out, std::size_t count);
+void ConvertFromBFloat16(const BFloat16* values, float* out, std::size_t count);
+
+void ConvertToFixed16(const float* values, Fixed16* out, std::size_t count);
+void ConvertFromFixed16(const Fixed16* values, float* out, std::size_t count);
+
+/*
+ * positions[i] += velocities[i] * deltaSeconds, the way a character moves every frame
+ * Half and BFloat16 do the math in float and round the result back, Fixed16 wraps around at the end of its range.
+ */
+void Integrate(Fixed16* positions, const Fixed16* velocities, Fixed16 deltaSeconds, std::size_t count);
+void Integrate(Half* positions, const Half* velocities, float deltaSeconds, std::size_t count);
+void Integrate(BFloat16* positions, const BFloat16* velocities, float deltaSeconds, std::size_t count);
+
+// The same without SIMD, to compare against
+void IntegrateScalar(Fixed16* positions, const Fixed16* velocities, Fixed16 deltaSeconds, std::size_t count);
+void IntegrateScalar(Half* positions, const Half* velocities, float deltaSeconds, std::size_t count);
+void IntegrateScalar(BFloat16* positions, const BFloat16* velocities, float deltaSeconds, std::size_t count);
@@ -0,0 +1,608 @@
+#include "PackageFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr std::uint32_t PackageTag = 0x9E2A83C1;
+
+    // PKG_FilterEditorOnly, set on cooked packages, which leave out editor-only data
+    constexpr std::uint32_t FilterEditorOnlyFlag = 0x80000000;
+
+    // EUnrealEngineObjectUE4Version, only the ones that change the parts of the header we read
+    constexpr std::int32_t OldestLoadableVersion = 214;
+    constexpr std::int32_t LoadForEditorGameVersion = 365;
+    constexpr std::int32_t TextInPackagesVersion = 459;
+    constexpr std::int32_t AssetsInEditorVersion = 485;
+    constexpr std::int32_t NameHashesVersion = 504;
+    constexpr std::int32_t PreloadDependenciesVersion = 507;
+    constexpr std::int32_t TemplateIndexVersion = 508;
+    constexpr std::int32_t LargeExportSizesVersion = 511;
+    constexpr std::int32_t LocalizationIdVersion = 516;
+    constexpr std::int32_t ImportPackageNameVersion = 520;
+
+    constexpr std::int32_t WrittenVersion = 498;
+
+    /*
+     * Reads little-endian values and stops at the end of the data instead of running past it
+     * After a failed read every following read fails too, so it's enough to check IsFailed() once in a while
+     */
+    class PackageReader
+    {
+    public:
+        PackageReader(const std::uint8_t* data, std::size_t size) : data(data), size(size) {}
+
+        bool IsFailed() const { return failed; }
+        std::size_t GetOffset() const { return offset; }
+        std::size_t GetRemaining() const { return failed ? 0 : size - offset; }
+
+        bool Seek(std::int64_t position)
+        {
+            if (position < 0 || static_cast<std::uint64_t>(position) > size)
+            {
+                failed = true;
+                return false;
+            }
+            offset = static_cast<std::size_t>(position);
+            return !failed;
+        }
+
+        void Skip(std::size_t bytes)
+        {
+            if (bytes > GetRemaining())
+            {
+                failed = true;
+                return;
+            }
+            offset += bytes;
+        }
+
+        std::int32_t ReadInt32() { return static_cast<std::int32_t>(ReadUInt32()); }
+
+        std::uint32_t ReadUInt32()
+        {
+            std::uint8_t bytes[4] = {};
+            Read(bytes, 4);
+            return static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8
+                | static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24;
+        }
+
+        std::int64_t ReadInt64()
+        {
+            const auto low = ReadUInt32();
+            const auto high = ReadUInt32();
+            return static_cast<std::int64_t>(static_cast<std::uint64_t>(high) << 32 | low);
+        }
+
+        // FString: a length including the terminating zero, negative for UTF-16 text
+        std::string ReadString()
+        {
+            const auto length = ReadInt32();
+            if (length == 0 || failed)
+            {
+                return std::string();
+            }
+
+            const auto characters = length > 0 ? static_cast<std::size_t>(length) : static_cast<std::size_t>(-static_cast<std::int64_t>(length));
+            const auto bytes = length > 0 ? characters : characters * 2;
+            if (bytes > GetRemaining())
+            {
+                failed = true;
+                return std::string();
+            }
+
+            const auto* text = data + offset;
+            offset += bytes;
+
+            if (length > 0)
+            {
+                return std::string(reinterpret_cast<const char*>(text), characters - 1);
+            }
+            return Utf16ToUtf8(text, characters - 1);
+        }
+
+    private:
+        void Read(std::uint8_t* destination, std::size_t bytes)
+        {
+            if (bytes > GetRemaining())
+            {
+                failed = true;
+                return;
+            }
+            std::memcpy(destination, data + offset, bytes);
+            offset += bytes;
+        }
+
+        static std::string Utf16ToUtf8(const std::uint8_t* text, std::size_t characters)
+        {
+            std::string result;
+            for (std::size_t i = 0; i < characters; i++)
+            {
+                std::uint32_t code = text[i * 2] | text[i * 2 + 1] << 8;
+
+                // Characters outside the first 65536 take two UTF-16 units (a surrogate pair)
+                if (code >= 0xD800 && code < 0xDC00 && i + 1 < characters)
+                {
+                    const std::uint32_t low = text[i * 2 + 2] | text[i * 2 + 3] << 8;
+                    if (low >= 0xDC00 && low < 0xE000)
+                    {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        i++;
+                    }
+                }
+
+                if (code < 0x80)
+                {
+                    result += static_cast<char>(code);
+                }
+                else if (code < 0x800)
+                {
+                    result += static_cast<char>(0xC0 | code >> 6);
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    result += static_cast<char>(0xE0 | code >> 12);
+                    result += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    result += static_cast<char>(0xF0 | code >> 18);
+                    result += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+                    result += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+            return result;
+        }
+
+        const std::uint8_t* data;
+        std::size_t size;
+        std::size_t offset = 0;
+        bool failed = false;
+    };
+
+    // An FName is an index into the name table and a number, "Widget_3" is saved as "Widget" with number 4 (0 means no number)
+    bool ReadName(PackageReader& reader, const std::vector<std::string>& names, std::string& name)
+    {
+        const auto index = reader.ReadInt32();
+        const auto number = reader.ReadInt32();
+        if (reader.IsFailed() || index < 0 || static_cast<std::size_t>(index) >= names.size())
+        {
+            return false;
+        }
+
+        name = names[index];
+        if (number > 0)
+        {
+            name += '_';
+            name += std::to_string(number - 1);
+        }
+        return true;
+    }
+
+    // Checks that a table fits into the file before anything is allocated for it
+    bool SeekTable(PackageReader& reader, std::int32_t count, std::int32_t offset, std::size_t minimumEntrySize)
+    {
+        return count >= 0 && reader.Seek(offset) && static_cast<std::size_t>(count) <= reader.GetRemaining() / minimumEntrySize;
+    }
+
+    /*
+     * Writing
+     */
+
+    class PackageWriter
+    {
+    public:
+        void WriteInt32(std::int32_t value) { WriteUInt32(static_cast<std::uint32_t>(value)); }
+
+        void WriteUInt32(std::uint32_t value)
+        {
+            for (auto i = 0; i < 4; i++)
+            {
+                bytes.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+            }
+        }
+
+        void WriteString(const std::string& text)
+        {
+            WriteInt32(static_cast<std::int32_t>(text.size() + 1));
+            bytes.insert(bytes.end(), text.begin(), text.end());
+            bytes.push_back(0);
+        }
+
+        void PatchInt32(std::size_t position, std::int32_t value)
+        {
+            for (auto i = 0; i < 4; i++)
+            {
+                bytes[position + i] = static_cast<std::uint8_t>(static_cast<std::uint32_t>(value) >> (i * 8));
+            }
+        }
+
+        std::int32_t GetOffset() const { return static_cast<std::int32_t>(bytes.size()); }
+
+        std::vector<std::uint8_t> bytes;
+    };
+}
+
+bool ReadPackage(const std::uint8_t* data, std::size_t size, PackageInfo& info, std::string& error)
+{
+    info = PackageInfo();
+    PackageReader reader(data, size);
+
+    /*
+     * Summary (FPackageFileSummary)
+     */
+
+    if (reader.ReadUInt32() != PackageTag)
+    {
+        error = "not a package file";
+        return false;
+    }
+
+    // The legacy version tells how the rest of the summary is laid out: -2 to -7 is UE4, -8 and below UE5
+    const auto legacyVersion = reader.ReadInt32();
+    if (legacyVersion >= 0 || legacyVersion < -7)
+    {
+        error = legacyVersion < -7 ? "UE5 packages aren't supported" : "UE3 packages aren't supported";
+        return false;
+    }
+
+    if (legacyVersion != -4)
+    {
+        reader.ReadInt32();
+    }
+    info.fileVersion = reader.ReadInt32();
+    reader.ReadInt32();
+
+    if (info.fileVersion == 0)
+    {
+        error = "unversioned (cooked) packages aren't supported";
+        return false;
+    }
+    if (info.fileVersion < OldestLoadableVersion)
+    {
+        error = "file version " + std::to_string(info.fileVersion) + " is too old";
+        return false;
+    }
+
+    // Custom versions of engine modules and plugins, their format depends on the legacy version
+    const auto customVersionCount = reader.ReadInt32();
+    if (customVersionCount < 0)
+    {
+        error = "broken custom versions";
+        return false;
+    }
+    for (auto i = 0; i < customVersionCount && !reader.IsFailed(); i++)
+    {
+        if (legacyVersion == -2)
+        {
+            reader.Skip(8);
+        }
+        else if (legacyVersion >= -5)
+        {
+            reader.Skip(20);
+            reader.ReadString();
+        }
+        else
+        {
+            reader.Skip(20);
+        }
+    }
+
+    info.totalHeaderSize = reader.ReadInt32();
+    reader.ReadString();
+    info.packageFlags = reader.ReadUInt32();
+
+    const auto nameCount = reader.ReadInt32();
+    const auto nameOffset = reader.ReadInt32();
+
+    if (info.fileVersion >= LocalizationIdVersion && (info.packageFlags & FilterEditorOnlyFlag) == 0)
+    {
+        reader.ReadString();
+    }
+    if (info.fileVersion >= TextInPackagesVersion)
+    {
+        reader.Skip(8);
+    }
+
+    const auto exportCount = reader.ReadInt32();
+    const auto exportOffset = reader.ReadInt32();
+    const auto importCount = reader.ReadInt32();
+    const auto importOffset = reader.ReadInt32();
+
+    if (reader.IsFailed())
+    {
+        error = "truncated summary";
+        return false;
+    }
+
+    /*
+     * Names (FNameEntrySerialized)
+     */
+
+    if (!SeekTable(reader, nameCount, nameOffset, 4))
+    {
+        error = "broken name table";
+        return false;
+    }
+
+    info.names.reserve(nameCount);
+    for (auto i = 0; i < nameCount; i++)
+    {
+        info.names.push_back(reader.ReadString());
+
+        // Case-insensitive and case-sensitive hashes, which we don't need
+        if (info.fileVersion >= NameHashesVersion)
+        {
+            reader.Skip(4);
+        }
+    }
+    if (reader.IsFailed())
+    {
+        error = "broken name table";
+        return false;
+    }
+
+    /*
+     * Imports (FObjectImport)
+     */
+
+    const auto importsHavePackageName = info.fileVersion >= ImportPackageNameVersion && (info.packageFlags & FilterEditorOnlyFlag) == 0;
+    const std::size_t importSize = 28 + (importsHavePackageName ? 8 : 0);
+
+    if (!SeekTable(reader, importCount, importOffset, importSize))
+    {
+        error = "broken import table";
+        return false;
+    }
+
+    info.imports.resize(importCount);
+    for (auto& import : info.imports)
+    {
+        auto valid = ReadName(reader, info.names, import.classPackage) && ReadName(reader, info.names, import.className);
+        import.outerIndex = reader.ReadInt32();
+        valid = valid && ReadName(reader, info.names, import.objectName);
+        if (importsHavePackageName)
+        {
+            reader.Skip(8);
+        }
+
+        if (!valid || reader.IsFailed())
+        {
+            error = "broken import table";
+            return false;
+        }
+
+        if (import.outerIndex == 0 && import.className == "Package")
+        {
+            info.dependencies.push_back(import.objectName);
+        }
+    }
+
+    std::sort(info.dependencies.begin(), info.dependencies.end());
+    info.dependencies.erase(std::unique(info.dependencies.begin(), info.dependencies.end()), info.dependencies.end());
+
+    /*
+     * Exports (FObjectExport)
+     */
+
+    const std::size_t exportSize = 64 + (info.fileVersion >= LoadForEditorGameVersion ? 4 : 0) + (info.fileVersion >= AssetsInEditorVersion ? 4 : 0)
+        + (info.fileVersion >= PreloadDependenciesVersion ? 20 : 0) + (info.fileVersion >= TemplateIndexVersion ? 4 : 0)
+        + (info.fileVersion >= LargeExportSizesVersion ? 8 : 0);
+
+    if (!SeekTable(reader, exportCount, exportOffset, exportSize))
+    {
+        error = "broken export table";
+        return false;
+    }
+
+    std::vector<std::int32_t> classIndices(exportCount);
+    info.exports.resize(exportCount);
+    for (auto i = 0; i < exportCount; i++)
+    {
+        auto& entry = info.exports[i];
+        const auto start = reader.GetOffset();
+
+        classIndices[i] = reader.ReadInt32();
+
+        // Super and template index
+        reader.Skip(info.fileVersion >= TemplateIndexVersion ? 8 : 4);
+
+        entry.outerIndex = reader.ReadInt32();
+        const auto valid = ReadName(reader, info.names, entry.objectName);
+
+        // Object flags
+        reader.Skip(4);
+
+        if (info.fileVersion >= LargeExportSizesVersion)
+        {
+            entry.serialSize = reader.ReadInt64();
+            entry.serialOffset = reader.ReadInt64();
+        }
+        else
+        {
+            entry.serialSize = reader.ReadInt32();
+            entry.serialOffset = reader.ReadInt32();
+        }
+
+        // Flags, package guid and package flags, and the preload dependencies, which we don't need
+        reader.Skip(exportSize - (reader.GetOffset() - start));
+
+        if (!valid || reader.IsFailed())
+        {
+            error = "broken export table";
+            return false;
+        }
+    }
+
+    // The class is an import (like StaticMesh) or, for blueprints, one of the package's own exports
+    for (auto i = 0; i < exportCount; i++)
+    {
+        const auto classIndex = classIndices[i];
+        if (classIndex < 0 && static_cast<std::size_t>(-static_cast<std::int64_t>(classIndex)) <= info.imports.size())
+        {
+            info.exports[i].className = info.imports[-classIndex - 1].objectName;
+        }
+        else if (classIndex > 0 && classIndex <= exportCount)
+        {
+            info.exports[i].className = info.exports[classIndex - 1].objectName;
+        }
+        else
+        {
+            info.exports[i].className = "Class";
+        }
+    }
+
+    return true;
+}
+
+std::vector<std::uint8_t> WritePackage(const std::vector<PackageImport>& imports, const std::vector<PackageExport>& exports, std::size_t bodySize)
+{
+    std::vector<std::string> names = { "None" };
+    const auto nameIndex = [&names](const std::string& name)
+    {
+        const auto found = std::find(names.begin(), names.end(), name);
+        if (found != names.end())
+        {
+            return static_cast<std::int32_t>(found - names.begin());
+        }
+        names.push_back(name);
+        return static_cast<std::int32_t>(names.size() - 1);
+    };
+
+    // Look up all names first, the name table comes before the tables using it
+    std::vector<std::int32_t> importNames;
+    for (const auto& import : imports)
+    {
+        importNames.push_back(nameIndex(import.classPackage));
+        importNames.push_back(nameIndex(import.className));
+        importNames.push_back(nameIndex(import.objectName));
+    }
+    std::vector<std::int32_t> exportNames;
+    std::vector<std::int32_t> exportClasses;
+    for (const auto& entry : exports)
+    {
+        exportNames.push_back(nameIndex(entry.objectName));
+
+        // Export classes point at the import of that name, exports without one become classes themselves
+        std::int32_t classIndex = 0;
+        for (std::size_t i = 0; i < imports.size(); i++)
+        {
+            if (imports[i].objectName == entry.className)
+            {
+                classIndex = -static_cast<std::int32_t>(i) - 1;
+                break;
+            }
+        }
+        exportClasses.push_back(classIndex);
+    }
+
+    PackageWriter writer;
+    writer.WriteUInt32(PackageTag);
+    writer.WriteInt32(-7);
+    writer.WriteInt32(864);
+    writer.WriteInt32(WrittenVersion);
+    writer.WriteInt32(0);
+    writer.WriteInt32(0);
+
+    const auto totalHeaderSizeAt = writer.bytes.size();
+    writer.WriteInt32(0);
+    writer.WriteString("None");
+    writer.WriteUInt32(0);
+    writer.WriteInt32(static_cast<std::int32_t>(names.size()));
+    const auto nameOffsetAt = writer.bytes.size();
+    writer.WriteInt32(0);
+
+    // Gatherable text
+    writer.WriteInt32(0);
+    writer.WriteInt32(0);
+
+    writer.WriteInt32(static_cast<std::int32_t>(exports.size()));
+    const auto exportOffsetAt = writer.bytes.size();
+    writer.WriteInt32(0);
+    writer.WriteInt32(static_cast<std::int32_t>(imports.size()));
+    const auto importOffsetAt = writer.bytes.size();
+    writer.WriteInt32(0);
+    const auto dependsOffsetAt = writer.bytes.size();
+    writer.WriteInt32(0);
+
+    // Soft package references, thumbnail table and guid. The rest of a real summary (engine versions,
+    // generations, asset registry data and so on) is left out since ReadPackage() never looks at it.
+    writer.WriteInt32(0);
+    writer.WriteInt32(0);
+    writer.WriteInt32(0);
+    for (auto i = 0; i < 4; i++)
+    {
+        writer.WriteUInt32(0);
+    }
+
+    writer.PatchInt32(nameOffsetAt, writer.GetOffset());
+    for (const auto& name : names)
+    {
+        writer.WriteString(name);
+    }
+
+    writer.PatchInt32(importOffsetAt, writer.GetOffset());
+    for (std::size_t i = 0; i < imports.size(); i++)
+    {
+        writer.WriteInt32(importNames[i * 3]);
+        writer.WriteInt32(0);
+        writer.WriteInt32(importNames[i * 3 + 1]);
+        writer.WriteInt32(0);
+        writer.WriteInt32(imports[i].outerIndex);
+        writer.WriteInt32(importNames[i * 3 + 2]);
+        writer.WriteInt32(0);
+    }
+
+    // 72 bytes per export in version 498, the sizes and offsets are patched in once the header size is known
+    const auto exportOffset = writer.GetOffset();
+    writer.PatchInt32(exportOffsetAt, exportOffset);
+    writer.bytes.resize(writer.bytes.size() + exports.size() * 72);
+
+    // Every export depends on nothing
+    writer.PatchInt32(dependsOffsetAt, writer.GetOffset());
+    for (std::size_t i = 0; i < exports.size(); i++)
+    {
+        writer.WriteInt32(0);
+    }
+
+    const auto headerSize = writer.GetOffset();
+    writer.PatchInt32(totalHeaderSizeAt, headerSize);
+
+    auto serialOffset = static_cast<std::int64_t>(headerSize);
+    for (std::size_t i = 0; i < exports.size(); i++)
+    {
+        const auto serialSize = static_cast<std::int64_t>(bodySize / exports.size() + (i < bodySize % exports.size() ? 1 : 0));
+        const auto at = static_cast<std::size_t>(exportOffset) + i * 72;
+        writer.PatchInt32(at, exportClasses[i]);
+        writer.PatchInt32(at + 8, exports[i].outerIndex);
+        writer.PatchInt32(at + 12, exportNames[i]);
+        writer.PatchInt32(at + 24, static_cast<std::int32_t>(serialSize));
+        writer.PatchInt32(at + 28, static_cast<std::int32_t>(serialOffset));
+
+        // bNotAlwaysLoadedForEditorGame and bIsAsset
+        writer.PatchInt32(at + 64, 1);
+        writer.PatchInt32(at + 68, exports[i].outerIndex == 0 ? 1 : 0);
+        serialOffset += serialSize;
+    }
+
+    // Made-up object data, seeded from the names so different packages get different bytes
+    std::uint32_t state = 2166136261u;
+    for (const auto& name : names)
+    {
+        for (auto character : name)
+        {
+            state = (state ^ static_cast<std::uint8_t>(character)) * 16777619u;
+        }
+    }
+    writer.bytes.reserve(writer.bytes.size() + bodySize);
+    for (std::size_t i = 0; i < bodySize; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        writer.bytes.push_back(static_cast<std::uint8_t>(state >> 24));
+    }
+
+    return writer.bytes;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+/*
+ * PackageFile - reading the tables at the start of a UE4 .uasset or .umap file
+ *
+ * Every package starts with a header that lists what's inside it and what it needs from elsewhere:
+ *
+ *      summary     versions, flags, and where the tables below start
+ *      names       every name the package uses, other tables refer to them by index (FName)
+ *      imports     objects from other packages, like the skeleton an animation plays on
+ *      exports     the objects this package contains, and where their data starts in the file
+ *
+ * Imports whose class is "Package" are the packages this one depends on, for example ThirdPersonJump_Start
+ * imports /Game/Mannequin/Character/Mesh/UE4_Mannequin_Skeleton. That's all a cooker needs to know which
+ * files to load first, without reading the (much bigger) object data after the header.
+ *
+ * ReadPackage() checks every offset and count before using it, a broken or truncated file gives an error instead of a crash.
+ * Packages saved by UE4.0 to UE4.27 with the editor are supported. Cooked packages without versions and UE5 packages are not.
+ *
+ * WritePackage() does the opposite for a small, made-up package, which is handy for tests and benchmarks.
+ * Only the header is real, the object data is filler.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct PackageImport
+{
+	std::string classPackage;
+	std::string className;
+	std::string objectName;
+
+	// 0: top level, < 0: another import (-1 is the first), > 0: an export (1 is the first)
+	std::int32_t outerIndex = 0;
+};
+
+struct PackageExport
+{
+	std::string className;
+	std::string objectName;
+	std::int32_t outerIndex = 0;
+
+	// Where the object's data is in the file
+	std::int64_t serialOffset = 0;
+	std::int64_t serialSize = 0;
+};
+
+struct PackageInfo
+{
+	std::int32_t fileVersion = 0;
+	std::uint32_t packageFlags = 0;
+	std::int32_t totalHeaderSize = 0;
+
+	std::vector<std::string> names;
+	std::vector<PackageImport> imports;
+	std::vector<PackageExport> exports;
+
+	// Packages this one imports from (like /Script/Engine or /Game/Mannequin/Character/Mesh/SK_Mannequin), sorted
+	std::vector<std::string> dependencies;
+};
+
+bool ReadPackage(const std::uint8_t* data, std::size_t size, PackageInfo& info, std::string& error);
+
+/*
+ * Writes a package with the given imports and exports, saved as file version 498 (UE4.22)
+ * Names are collected from the imports and exports, the export offsets and sizes are filled in.
+ * 'bodySize' bytes of object data are spread over the exports.
+ */
+std::vector<std::uint8_t> WritePackage(const std::vector<PackageImport>& imports, const std::vector<PackageExport>& exports, std::size_t bodySize);
@@ -0,0 +1,414 @@
+#include "PathFinder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr float Diagonal = 1.41421356f;
+
+    // Distance with 8 directions of movement, in cells
+    float Octile(int fromX, int fromY, int toX, int toY)
+    {
+        const auto dx = std::abs(toX - fromX);
+        const auto dy = std::abs(toY - fromY);
+        return static_cast<float>(std::max(dx, dy)) + (Diagonal - 1.0f) * static_cast<float>(std::min(dx, dy));
+    }
+
+    int Sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+
+    bool HeapCompare(const std::pair<float, std::int32_t>& a, const std::pair<float, std::int32_t>& b)
+    {
+        return a.first > b.first;
+    }
+}
+
+PathFinder::PathFinder(const NavigationGrid& grid)
+    : grid(grid)
+{
+    const auto cells = static_cast<std::size_t>(grid.GetWidth()) * grid.GetHeight();
+    stamps.assign(cells, 0);
+    costs.assign(cells, 0.0f);
+    parents.assign(cells, -1);
+    closed.assign(cells, 0);
+}
+
+bool PathFinder::IsOpen(int x, int y) const
+{
+    if (!grid.IsWalkable(x, y))
+    {
+        return false;
+    }
+    return !useCorridor || corridor[grid.GetRegion(x, y)] == corridorStamp;
+}
+
+void PathFinder::BeginSearch()
+{
+    stamp++;
+    if (stamp == 0)
+    {
+        // Wrapped around after 4 billion searches, old stamps could look current again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+    open.clear();
+}
+
+void PathFinder::Push(std::size_t cell, float cost, std::int32_t parent, GridPoint goal, std::size_t& expanded)
+{
+    if (stamps[cell] != stamp)
+    {
+        stamps[cell] = stamp;
+        costs[cell] = std::numeric_limits<float>::max();
+        closed[cell] = 0;
+    }
+
+    if (closed[cell] != 0 || cost >= costs[cell])
+    {
+        return;
+    }
+
+    costs[cell] = cost;
+    parents[cell] = parent;
+
+    const auto x = static_cast<int>(cell % grid.GetWidth());
+    const auto y = static_cast<int>(cell / grid.GetWidth());
+    open.push_back({ cost + Octile(x, y, goal.x, goal.y), static_cast<std::int32_t>(cell) });
+    std::push_heap(open.begin(), open.end(), HeapCompare);
+    expanded++;
+}
+
+PathResult PathFinder::Finish(GridPoint goal, std::size_t expanded) const
+{
+    PathResult result;
+    result.found = true;
+    result.expanded = expanded;
+
+    for (auto cell = static_cast<std::int32_t>(grid.Index(goal.x, goal.y)); cell != -1; cell = parents[cell])
+    {
+        const GridPoint point = { cell % grid.GetWidth(), cell / grid.GetWidth() };
+
+        // Leave out points in the middle of a straight line, A* has one for every cell
+        const auto size = result.points.size();
+        if (size >= 2)
+        {
+            const auto& a = result.points[size - 2];
+            const auto& b = result.points[size - 1];
+            if (Sign(b.x - a.x) == Sign(point.x - b.x) && Sign(b.y - a.y) == Sign(point.y - b.y))
+            {
+                result.points.back() = point;
+                continue;
+            }
+        }
+        result.points.push_back(point);
+    }
+    std::reverse(result.points.begin(), result.points.end());
+
+    for (std::size_t i = 1; i < result.points.size(); i++)
+    {
+        result.length += Octile(result.points[i - 1].x, result.points[i - 1].y, result.points[i].x, result.points[i].y);
+    }
+    result.length *= grid.GetCellSize();
+
+    return result;
+}
+
+/*
+ * Jump Point Search
+ *
+ * Moving straight, a jump stops where a wall beside the path ends: the path might have to turn around that corner.
+ * Moving diagonally, it stops wherever a straight jump in one of its two directions would find something.
+ */
+
+bool PathFinder::JumpStraight(int x, int y, int dx, int dy, GridPoint goal, GridPoint& jumpPoint) const
+{
+    while (true)
+    {
+        x += dx;
+        y += dy;
+
+        if (!IsOpen(x, y))
+        {
+            return false;
+        }
+
+        const auto forced = dx != 0
+            ? (IsOpen(x, y - 1) && !IsOpen(x - dx, y - 1)) || (IsOpen(x, y + 1) && !IsOpen(x - dx, y + 1))
+            : (IsOpen(x - 1, y) && !IsOpen(x - 1, y - dy)) || (IsOpen(x + 1, y) && !IsOpen(x + 1, y - dy));
+
+        if ((x == goal.x && y == goal.y) || forced)
+        {
+            jumpPoint = { x, y };
+            return true;
+        }
+    }
+}
+
+bool PathFinder::Jump(int x, int y, int dx, int dy, GridPoint goal, GridPoint& jumpPoint) const
+{
+    if (dx == 0 || dy == 0)
+    {
+        return JumpStraight(x, y, dx, dy, goal, jumpPoint);
+    }
+
+    while (true)
+    {
+        // No cutting corners: both cells beside the diagonal step must be open
+        if (!IsOpen(x + dx, y) || !IsOpen(x, y + dy))
+        {
+            return false;
+        }
+
+        x += dx;
+        y += dy;
+
+        if (!IsOpen(x, y))
+        {
+            return false;
+        }
+
+        GridPoint ignored;
+        if ((x == goal.x && y == goal.y) || JumpStraight(x, y, dx, 0, goal, ignored) || JumpStraight(x, y, 0, dy, goal, ignored))
+        {
+            jumpPoint = { x, y };
+            return true;
+        }
+    }
+}
+
+bool PathFinder::MarkCorridor(GridPoint start, GridPoint goal)
+{
+    const auto& regions = grid.GetRegions();
+    const auto startRegion = grid.GetRegion(start.x, start.y);
+    const auto goalRegion = grid.GetRegion(goal.x, goal.y);
+
+    if (corridor.size() != regions.size())
+    {
+        corridor.assign(regions.size(), 0);
+    }
+    corridorStamp++;
+
+    // A* over the regions, they're few enough that plain vectors are fine
+    std::vector<float> regionCosts(regions.size(), std::numeric_limits<float>::max());
+    std::vector<std::int32_t> regionParents(regions.size(), -1);
+    std::vector<std::pair<float, std::int32_t>> regionOpen;
+
+    const auto distance = [&regions](std::int32_t a, std::int32_t b)
+    {
+        const auto dx = regions[a].centerX - regions[b].centerX;
+        const auto dy = regions[a].centerY - regions[b].centerY;
+        return std::sqrt(dx * dx + dy * dy);
+    };
+
+    regionCosts[startRegion] = 0.0f;
+    regionOpen.push_back({ distance(startRegion, goalRegion), startRegion });
+    while (!regionOpen.empty())
+    {
+        std::pop_heap(regionOpen.begin(), regionOpen.end(), HeapCompare);
+        const auto [estimate, region] = regionOpen.back();
+        regionOpen.pop_back();
+
+        if (region == goalRegion)
+        {
+            break;
+        }
+        if (estimate > regionCosts[region] + distance(region, goalRegion) + 1e-3f)
+        {
+            continue;
+        }
+
+        for (auto neighbour : regions[region].neighbours)
+        {
+            const auto cost = regionCosts[region] + distance(region, neighbour);
+            if (cost < regionCosts[neighbour])
+            {
+                regionCosts[neighbour] = cost;
+                regionParents[neighbour] = region;
+                regionOpen.push_back({ cost + distance(neighbour, goalRegion), neighbour });
+                std::push_heap(regionOpen.begin(), regionOpen.end(), HeapCompare);
+            }
+        }
+    }
+
+    if (goalRegion != startRegion && regionParents[goalRegion] == -1)
+    {
+        return false;
+    }
+
+    // The regions on the way and the ones next to them, so the path can cut across where that's shorter
+    for (auto region = goalRegion; region != -1; region = regionParents[region])
+    {
+        corridor[region] = corridorStamp;
+        for (auto neighbour : regions[region].neighbours)
+        {
+            corridor[neighbour] = corridorStamp;
+        }
+    }
+    return true;
+}
+
+PathResult PathFinder::FindPath(GridPoint start, GridPoint goal, bool hierarchical)
+{
+    useCorridor = false;
+    if (!grid.IsWalkable(start.x, start.y) || !grid.IsWalkable(goal.x, goal.y))
+    {
+        return {};
+    }
+
+    // Different components are never connected, no need to search
+    const auto& regions = grid.GetRegions();
+    if (regions[grid.GetRegion(start.x, start.y)].component != regions[grid.GetRegion(goal.x, goal.y)].component)
+    {
+        return {};
+    }
+
+    useCorridor = hierarchical && MarkCorridor(start, goal);
+
+    BeginSearch();
+    std::size_t expanded = 0;
+    Push(grid.Index(start.x, start.y), 0.0f, -1, goal, expanded);
+
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), HeapCompare);
+        const auto cell = open.back().second;
+        open.pop_back();
+
+        if (closed[cell] != 0)
+        {
+            continue;
+        }
+        closed[cell] = 1;
+
+        const auto x = cell % grid.GetWidth();
+        const auto y = cell / grid.GetWidth();
+        if (x == goal.x && y == goal.y)
+        {
+            useCorridor = false;
+            return Finish(goal, expanded);
+        }
+
+        // Only the directions that can lead somewhere new, given where we came from
+        int directions[8][2];
+        auto directionCount = 0;
+        const auto add = [&](int dx, int dy)
+        {
+            directions[directionCount][0] = dx;
+            directions[directionCount][1] = dy;
+            directionCount++;
+        };
+
+        const auto parent = parents[cell];
+        if (parent == -1)
+        {
+            for (auto dy = -1; dy <= 1; dy++)
+            {
+                for (auto dx = -1; dx <= 1; dx++)
+                {
+                    if (dx != 0 || dy != 0)
+                    {
+                        add(dx, dy);
+                    }
+                }
+            }
+        }
+        else
+        {
+            const auto dx = Sign(x - parent % grid.GetWidth());
+            const auto dy = Sign(y - parent / grid.GetWidth());
+            if (dx != 0 && dy != 0)
+            {
+                add(dx, 0);
+                add(0, dy);
+                add(dx, dy);
+            }
+            else if (dx != 0)
+            {
+                add(dx, 0);
+                add(dx, 1);
+                add(dx, -1);
+                add(0, 1);
+                add(0, -1);
+            }
+            else
+            {
+                add(0, dy);
+                add(1, dy);
+                add(-1, dy);
+                add(1, 0);
+                add(-1, 0);
+            }
+        }
+
+        for (auto i = 0; i < directionCount; i++)
+        {
+            GridPoint jumpPoint;
+            if (Jump(x, y, directions[i][0], directions[i][1], goal, jumpPoint))
+            {
+                Push(grid.Index(jumpPoint.x, jumpPoint.y), costs[cell] + Octile(x, y, jumpPoint.x, jumpPoint.y), cell, goal, expanded);
+            }
+        }
+    }
+
+    // Can't happen with a correct corridor, but if it does the full search still finds the path
+    if (useCorridor)
+    {
+        return FindPath(start, goal, false);
+    }
+    return {};
+}
+
+PathResult PathFinder::FindPathAStar(GridPoint start, GridPoint goal)
+{
+    useCorridor = false;
+    if (!grid.IsWalkable(start.x, start.y) || !grid.IsWalkable(goal.x, goal.y))
+    {
+        return {};
+    }
+
+    BeginSearch();
+    std::size_t expanded = 0;
+    Push(grid.Index(start.x, start.y), 0.0f, -1, goal, expanded);
+
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), HeapCompare);
+        const auto cell = open.back().second;
+        open.pop_back();
+
+        if (closed[cell] != 0)
+        {
+            continue;
+        }
+        closed[cell] = 1;
+
+        const auto x = cell % grid.GetWidth();
+        const auto y = cell / grid.GetWidth();
+        if (x == goal.x && y == goal.y)
+        {
+            return Finish(goal, expanded);
+        }
+
+        for (auto dy = -1; dy <= 1; dy++)
+        {
+            for (auto dx = -1; dx <= 1; dx++)
+            {
+                if ((dx == 0 && dy == 0) || !IsOpen(x + dx, y + dy))
+                {
+                    continue;
+                }
+                if (dx != 0 && dy != 0 && (!IsOpen(x + dx, y) || !IsOpen(x, y + dy)))
+                {
+                    continue;
+                }
+
+                Push(grid.Index(x + dx, y + dy), costs[cell] + (dx != 0 && dy != 0 ? Diagonal : 1.0f), cell, goal, expanded);
+            }
+        }
+    }
+
+    return {};
+}
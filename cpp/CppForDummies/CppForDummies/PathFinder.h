@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+ * PathFinder - finding the shortest way between two cells of a NavigationGrid
+ *
+ * FindPathAStar() is plain A*: it looks at every cell around the cell it's at, which on open ground means
+ * looking at a huge number of cells that all lead the same way.
+ *
+ * FindPath() uses Jump Point Search (JPS) instead. It runs in straight lines and diagonals over open ground
+ * and only stops where something interesting happens (a corner around which the path might turn).
+ * It finds equally short paths while only putting a few 'jump points' into the open list.
+ * Characters move in 8 directions, but never diagonally past a corner.
+ *
+ * With 'hierarchical' set, FindPath() first finds the way through the grid's regions (see NavigationGrid.h) and then
+ * only searches cells in those regions and the ones next to them. That's much faster on big maps, and paths are
+ * at most slightly longer.
+ *
+ * A PathFinder keeps search data for every cell, so every thread needs its own. The grid may be shared.
+ */
+
+#include "NavigationGrid.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+struct PathResult
+{
+	bool found = false;
+
+	// The corners of the path from start to goal, straight or diagonal lines in between
+	std::vector<GridPoint> points;
+
+	// In centimeters
+	float length = 0.0f;
+
+	// Cells put into the open list, a measure of how much work the search was
+	std::size_t expanded = 0;
+};
+
+class PathFinder
+{
+public:
+	explicit PathFinder(const NavigationGrid& grid);
+
+	PathResult FindPath(GridPoint start, GridPoint goal, bool hierarchical = true);
+	PathResult FindPathAStar(GridPoint start, GridPoint goal);
+
+private:
+	bool IsOpen(int x, int y) const;
+	bool Jump(int x, int y, int dx, int dy, GridPoint goal, GridPoint& jumpPoint) const;
+	bool JumpStraight(int x, int y, int dx, int dy, GridPoint goal, GridPoint& jumpPoint) const;
+	bool MarkCorridor(GridPoint start, GridPoint goal);
+
+	void BeginSearch();
+	void Push(std::size_t cell, float cost, std::int32_t parent, GridPoint goal, std::size_t& expanded);
+	PathResult Finish(GridPoint goal, std::size_t expanded) const;
+
+	const NavigationGrid& grid;
+
+	// Per cell, only valid when its stamp matches the current search, so nothing needs clearing between searches
+	std::vector<std::uint32_t> stamps;
+	std::vector<float> costs;
+	std::vector<std::int32_t> parents;
+	std::vector<std::uint8_t> closed;
+	std::uint32_t stamp = 0;
+
+	// Estimated total cost and cell. std::push_heap keeps the largest on top, so the comparison is reversed.
+	std::vector<std::pair<float, std::int32_t>> open;
+
+	// Regions the hierarchical search may use, marked with 'corridorStamp'
+	std::vector<std::uint32_t> corridor;
+	std::uint32_t corridorStamp = 0;
+	bool useCorridor = false;
+};
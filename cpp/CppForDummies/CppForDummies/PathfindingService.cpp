@@ -0,0 +1,257 @@
+#include "PathfindingService.h"
+#include <algorithm>
+
+/*
+ * PathCache
+ */
+
+PathCache::PathCache(std::size_t capacity)
+    : capacity(std::max<std::size_t>(capacity, 1))
+{
+    index.Reserve(this->capacity);
+}
+
+std::uint64_t PathCache::MakeKey(PathRequest request)
+{
+    // 16 bits per coordinate is plenty, grids bigger than 65536 cells across wouldn't fit in memory anyway
+    return static_cast<std::uint64_t>(request.start.x & 0xFFFF) | static_cast<std::uint64_t>(request.start.y & 0xFFFF) << 16
+        | static_cast<std::uint64_t>(request.goal.x & 0xFFFF) << 32 | static_cast<std::uint64_t>(request.goal.y & 0xFFFF) << 48;
+}
+
+void PathCache::Unlink(std::int32_t entry)
+{
+    auto& unlinked = entries[entry];
+    (unlinked.previous != -1 ? entries[unlinked.previous].next : head) = unlinked.next;
+    (unlinked.next != -1 ? entries[unlinked.next].previous : tail) = unlinked.previous;
+    unlinked.previous = -1;
+    unlinked.next = -1;
+}
+
+void PathCache::PushFront(std::int32_t entry)
+{
+    entries[entry].previous = -1;
+    entries[entry].next = head;
+    (head != -1 ? entries[head].previous : tail) = entry;
+    head = entry;
+}
+
+void PathCache::Remove(std::int32_t entry)
+{
+    Unlink(entry);
+    index.Remove(entries[entry].key);
+    entries[entry].result = PathResult();
+    entries[entry].clusters.clear();
+    freeEntries.push_back(entry);
+}
+
+bool PathCache::Find(PathRequest request, PathResult& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto entry = index.Find(MakeKey(request));
+    if (entry == nullptr)
+    {
+        stats.misses++;
+        return false;
+    }
+
+    stats.hits++;
+    Unlink(*entry);
+    PushFront(*entry);
+    result = entries[*entry].result;
+    return true;
+}
+
+void PathCache::Add(PathRequest request, const PathResult& result, std::vector<int> clusters)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Another thread may have found the same path in the meantime
+    const auto key = MakeKey(request);
+    if (index.Contains(key))
+    {
+        return;
+    }
+
+    if (index.Num() >= capacity)
+    {
+        stats.evictions++;
+        Remove(tail);
+    }
+
+    std::int32_t entry;
+    if (freeEntries.empty())
+    {
+        entry = static_cast<std::int32_t>(entries.size());
+        entries.emplace_back();
+    }
+    else
+    {
+        entry = freeEntries.back();
+        freeEntries.pop_back();
+    }
+
+    entries[entry].key = key;
+    entries[entry].result = result;
+    entries[entry].clusters = std::move(clusters);
+    PushFront(entry);
+    index.Add(key, entry);
+}
+
+void PathCache::Invalidate(int minClusterX, int minClusterY, int maxClusterX, int maxClusterY, int clusterColumns)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto entry = head; entry != -1;)
+    {
+        const auto next = entries[entry].next;
+
+        auto affected = !entries[entry].result.found;
+        for (auto cluster : entries[entry].clusters)
+        {
+            const auto x = cluster % clusterColumns;
+            const auto y = cluster / clusterColumns;
+            if (x >= minClusterX && x <= maxClusterX && y >= minClusterY && y <= maxClusterY)
+            {
+                affected = true;
+                break;
+            }
+        }
+
+        if (affected)
+        {
+            stats.invalidations++;
+            Remove(entry);
+        }
+        entry = next;
+    }
+}
+
+void PathCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    freeEntries.clear();
+    index.Empty();
+    head = -1;
+    tail = -1;
+}
+
+PathCacheStats PathCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::size_t PathCache::Num() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.Num();
+}
+
+/*
+ * PathfindingService
+ */
+
+PathfindingService::PathfindingService(NavigationGrid& grid, int threadCount, std::size_t cacheCapacity)
+    : grid(grid), threadCount(std::max(threadCount, 1)), cache(cacheCapacity)
+{
+    for (auto i = 0; i < this->threadCount; i++)
+    {
+        finders.push_back(std::make_unique<PathFinder>(grid));
+    }
+    if (this->threadCount > 1)
+    {
+        pool = std::make_unique<ThreadPoolExecutor>(this->threadCount);
+    }
+}
+
+std::vector<int> PathfindingService::GetClusters(const PathResult& result) const
+{
+    // Walk every cell along the path, the lines between points are always straight or diagonal
+    std::vector<int> clusters;
+    for (std::size_t i = 0; i < result.points.size(); i++)
+    {
+        auto point = result.points[i];
+        const auto end = i + 1 < result.points.size() ? result.points[i + 1] : point;
+        const auto dx = (end.x > point.x) - (end.x < point.x);
+        const auto dy = (end.y > point.y) - (end.y < point.y);
+
+        while (true)
+        {
+            const auto cluster = grid.GetCluster(point.x, point.y);
+            if (clusters.empty() || clusters.back() != cluster)
+            {
+                clusters.push_back(cluster);
+            }
+            if (point == end)
+            {
+                break;
+            }
+            point.x += dx;
+            point.y += dy;
+        }
+    }
+
+    std::sort(clusters.begin(), clusters.end());
+    clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+    return clusters;
+}
+
+PathResult PathfindingService::Serve(PathFinder& finder, const PathRequest& request)
+{
+    PathResult result;
+    if (cache.Find(request, result))
+    {
+        return result;
+    }
+
+    result = finder.FindPath(request.start, request.goal, hierarchical);
+    cache.Add(request, result, GetClusters(result));
+    return result;
+}
+
+// Every worker takes the next request until none are left, so a few long paths don't leave the others idle
+Task<void> PathfindingService::ServeRequests(const std::vector<PathRequest>& requests, std::vector<PathResult>& results, std::atomic<std::size_t>& next, PathFinder& finder)
+{
+    for (auto i = next.fetch_add(1, std::memory_order_relaxed); i < requests.size(); i = next.fetch_add(1, std::memory_order_relaxed))
+    {
+        results[i] = Serve(finder, requests[i]);
+    }
+    co_return;
+}
+
+std::vector<PathResult> PathfindingService::FindPaths(const std::vector<PathRequest>& requests)
+{
+    std::vector<PathResult> results(requests.size());
+
+    if (threadCount == 1 || requests.size() < 2)
+    {
+        for (std::size_t i = 0; i < requests.size(); i++)
+        {
+            results[i] = Serve(*finders[0], requests[i]);
+        }
+        return results;
+    }
+
+    std::atomic<std::size_t> next{ 0 };
+    for (auto& finder : finders)
+    {
+        Spawn(*pool, ServeRequests(requests, results, next, *finder));
+    }
+    pool->Run();
+
+    return results;
+}
+
+void PathfindingService::UpdateRegion(const HeightField& heightField, GridPoint min, GridPoint max)
+{
+    grid.Rebuild(heightField, min, max);
+
+    // Walkability can change a little past the changed cells
+    const auto reach = grid.GetChangeReach();
+    const auto clusterSize = grid.GetClusterSize();
+    cache.Invalidate(std::max(min.x - reach, 0) / clusterSize, std::max(min.y - reach, 0) / clusterSize,
+        (max.x + reach) / clusterSize, (max.y + reach) / clusterSize, grid.GetClusterColumns());
+}
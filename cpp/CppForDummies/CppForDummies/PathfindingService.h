@@ -0,0 +1,120 @@
+#pragma once
+
+/*
+ * PathfindingService - answering many path requests at once
+ *
+ * AI characters ask for paths all the time, and often for the same ones (everyone runs to the same spot).
+ * The service hands a batch of requests to its own pool of worker threads, each with its own PathFinder,
+ * and remembers recent results in a PathCache.
+ *
+ * When the level changes, UpdateRegion() rebuilds that part of the grid and throws away cached paths that
+ * went through it. Paths elsewhere stay cached, even though a shorter way might have opened up.
+ *
+ *      PathfindingService service(grid, 4, 4096);
+ *      auto results = service.FindPaths(requests);
+ */
+
+#include "Coroutines.h"
+#include "FlatHashMap.h"
+#include "NavigationGrid.h"
+#include "PathFinder.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct PathRequest
+{
+	GridPoint start;
+	GridPoint goal;
+};
+
+struct PathCacheStats
+{
+	std::size_t hits = 0;
+	std::size_t misses = 0;
+	std::size_t evictions = 0;
+	std::size_t invalidations = 0;
+};
+
+/*
+ * Least recently used (LRU) cache of paths
+ *
+ * Entries are kept in a list from most to least recently used. When the cache is full, the last one goes.
+ * Every entry remembers the clusters its path crosses, so changes to the grid only drop the paths they affect.
+ * Safe to use from several threads.
+ */
+class PathCache
+{
+public:
+	explicit PathCache(std::size_t capacity);
+
+	bool Find(PathRequest request, PathResult& result);
+	void Add(PathRequest request, const PathResult& result, std::vector<int> clusters);
+
+	// Drops every path crossing a cluster inside the rectangle, and every 'no path' result, since any change could open one up
+	void Invalidate(int minClusterX, int minClusterY, int maxClusterX, int maxClusterY, int clusterColumns);
+
+	void Clear();
+
+	PathCacheStats GetStats() const;
+	std::size_t Num() const;
+
+private:
+	struct Entry
+	{
+		std::uint64_t key = 0;
+		PathResult result;
+		std::vector<int> clusters;
+		std::int32_t previous = -1;
+		std::int32_t next = -1;
+	};
+
+	static std::uint64_t MakeKey(PathRequest request);
+
+	void Unlink(std::int32_t index);
+	void PushFront(std::int32_t index);
+	void Remove(std::int32_t index);
+
+	std::size_t capacity;
+	std::vector<Entry> entries;
+	std::vector<std::int32_t> freeEntries;
+	FlatHashMap<std::uint64_t, std::int32_t> index;
+	std::int32_t head = -1;
+	std::int32_t tail = -1;
+	PathCacheStats stats;
+	mutable std::mutex mutex;
+};
+
+class PathfindingService
+{
+public:
+	PathfindingService(NavigationGrid& grid, int threadCount, std::size_t cacheCapacity);
+
+	// Results are in the same order as the requests. Not safe to call from several threads at once.
+	std::vector<PathResult> FindPaths(const std::vector<PathRequest>& requests);
+
+	// The height field changed between min and max, must not be called while FindPaths() runs
+	void UpdateRegion(const HeightField& heightField, GridPoint min, GridPoint max);
+
+	PathCache& GetCache() { return cache; }
+
+	// With hierarchical pathfinding off, every path is the shortest possible (but takes longer to find)
+	void SetHierarchical(bool enabled) { hierarchical = enabled; }
+
+private:
+	PathResult Serve(PathFinder& finder, const PathRequest& request);
+	Task<void> ServeRequests(const std::vector<PathRequest>& requests, std::vector<PathResult>& results, std::atomic<std::size_t>& next, PathFinder& finder);
+	std::vector<int> GetClusters(const PathResult& result) const;
+
+	NavigationGrid& grid;
+	int threadCount;
+	bool hierarchical = true;
+	PathCache cache;
+	std::vector<std::unique_ptr<PathFinder>> finders;
+
+	// Started once with the service, its threads wait between batches. Not created for a single thread.
+	std::unique_ptr<ThreadPoolExecutor> pool;
+};
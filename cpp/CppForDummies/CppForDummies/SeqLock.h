@@ -0,0 +1,125 @@
+#pragma once
+
+/*
+ * SeqLock - one thread writes a small value, any number of threads read it, nobody takes a lock
+ *
+ * A mutex makes every reader write to the mutex, so with many readers they all fight over the same cache line
+ * even though none of them changes anything. Here readers only read, so adding readers doesn't slow the others down.
+ *
+ * The value is kept twice, and a sequence number says which copy is safe to read (even: the first, odd: the second).
+ * The writer moves readers over to the second copy, changes the first, moves them back and then changes the second.
+ * Readers never wait for the writer to finish. A read is only repeated if the sequence number changed while it was
+ * reading, which means the writer got through half an update in that short time.
+ *
+ *      SeqLock<Position> position;
+ *
+ *      // The one writer thread
+ *      position.Store({ x, y, z });
+ *
+ *      // Any other thread
+ *      auto current = position.Load();
+ *
+ * T must be trivially copyable (no pointers it owns, no virtual functions) and default constructible. Keep it small,
+ * every read copies the whole thing.
+ */
+
+#include "EventQueue.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class SeqLock
+{
+	static_assert(std::is_trivially_copyable_v<T>, "SeqLock copies T byte by byte");
+	static_assert(std::is_default_constructible_v<T>, "SeqLock needs to create a T to copy into");
+
+public:
+	explicit SeqLock(const T& value = T{})
+	{
+		const auto words = ToWords(value);
+		WriteCopy(copies[0], words);
+		WriteCopy(copies[1], words);
+	}
+
+	SeqLock(const SeqLock&) = delete;
+	SeqLock& operator=(const SeqLock&) = delete;
+
+	// Any thread
+	T Load() const
+	{
+		Words words;
+		while (true)
+		{
+			const auto before = sequence.load(std::memory_order_acquire);
+
+			const auto& copy = copies[before & 1];
+			for (std::size_t i = 0; i < WordCount; i++)
+			{
+				words[i] = copy[i].load(std::memory_order_relaxed);
+			}
+
+			// Keeps the reads above from moving below the check
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence.load(std::memory_order_relaxed) == before)
+			{
+				break;
+			}
+		}
+
+		T value;
+		std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+		return value;
+	}
+
+	// Only ever from one thread at a time
+	void Store(const T& value)
+	{
+		const auto words = ToWords(value);
+		const auto current = sequence.load(std::memory_order_relaxed);
+
+		// Readers switch to the second copy, the fence keeps the writes below from moving above the switch
+		sequence.store(current + 1, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_release);
+		WriteCopy(copies[0], words);
+
+		// And back to the first one, which now holds the new value
+		sequence.store(current + 2, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_release);
+		WriteCopy(copies[1], words);
+	}
+
+	// How many times the value was stored, handy for telling whether it changed since the last look
+	std::uint64_t GetVersion() const
+	{
+		return sequence.load(std::memory_order_acquire) / 2;
+	}
+
+private:
+	// The copies are made of atomic words, so reading one while it's being written is allowed (it's just thrown away)
+	static constexpr std::size_t WordCount = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+	using Words = std::array<std::uint64_t, WordCount>;
+	using Copy = std::array<std::atomic<std::uint64_t>, WordCount>;
+
+	static Words ToWords(const T& value)
+	{
+		Words words{};
+		std::memcpy(words.data(), &value, sizeof(T));
+		return words;
+	}
+
+	static void WriteCopy(Copy& copy, const Words& words)
+	{
+		for (std::size_t i = 0; i < WordCount; i++)
+		{
+			copy[i].store(words[i], std::memory_order_relaxed);
+		}
+	}
+
+	// Everything is written by the writer only, so it can share a cache line. Just not with whatever is next to the lock.
+	alignas(CacheLineSize) std::atomic<std::uint64_t> sequence{ 0 };
+	Copy copies[2];
+};
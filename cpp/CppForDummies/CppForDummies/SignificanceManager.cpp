@@ -0,0 +1,231 @@
+#include "SignificanceManager.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SignificanceManager::SignificanceManager()
+    : SignificanceManager({ { 1500.0f, 1 }, { 5000.0f, 2 }, { 15000.0f, 4 }, { std::numeric_limits<float>::max(), 8 } })
+{
+}
+
+SignificanceManager::SignificanceManager(std::vector<SignificanceTier> tiers)
+    : tiers(std::move(tiers))
+{
+    this->tiers.resize(std::clamp<std::size_t>(this->tiers.size(), 1, SignificanceStats::MaxTiers), { std::numeric_limits<float>::max(), 1 });
+    buckets.resize(this->tiers.size());
+    cursors.resize(this->tiers.size(), 0);
+}
+
+SignificanceManager::Handle SignificanceManager::Register(TickFunction tick)
+{
+    std::uint32_t index;
+    if (freeSlots.empty())
+    {
+        index = static_cast<std::uint32_t>(objects.size());
+        objects.emplace_back();
+    }
+    else
+    {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+
+    auto& object = objects[index];
+    const auto generation = object.generation;
+    object = Object();
+    object.tick = std::move(tick);
+    object.alive = true;
+    object.generation = generation;
+
+    // Spread objects over the frames, otherwise everything registered at once would be due on the same frame
+    object.framesSinceTick = static_cast<int>(index % 8);
+    return { index, generation };
+}
+
+void SignificanceManager::Unregister(Handle handle)
+{
+    // Unregistering twice would put the slot on the free list twice, and two objects would end up sharing it
+    auto object = Find(handle);
+    if (object == nullptr)
+    {
+        return;
+    }
+
+    const auto generation = object->generation + 1;
+    *object = Object();
+    object->generation = generation;
+    freeSlots.push_back(handle.index);
+}
+
+SignificanceManager::Object* SignificanceManager::Find(Handle handle)
+{
+    return const_cast<Object*>(static_cast<const SignificanceManager*>(this)->Find(handle));
+}
+
+const SignificanceManager::Object* SignificanceManager::Find(Handle handle) const
+{
+    if (handle.index >= objects.size())
+    {
+        return nullptr;
+    }
+
+    const auto& object = objects[handle.index];
+    return object.alive && object.generation == handle.generation ? &object : nullptr;
+}
+
+void SignificanceManager::SetLocation(Handle handle, float x, float y, float z)
+{
+    auto object = Find(handle);
+    if (object == nullptr)
+    {
+        return;
+    }
+
+    object->location[0] = x;
+    object->location[1] = y;
+    object->location[2] = z;
+}
+
+int SignificanceManager::GetTier(Handle handle) const
+{
+    const auto object = Find(handle);
+    return object != nullptr ? object->tier : -1;
+}
+
+int SignificanceManager::ComputeTier(const SignificanceView& view, const Object& object) const
+{
+    const float offset[3] = {
+        object.location[0] - view.location[0],
+        object.location[1] - view.location[1],
+        object.location[2] - view.location[2]
+    };
+    const auto distance = std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+
+    const auto last = static_cast<int>(tiers.size()) - 1;
+    auto tier = 0;
+    while (tier < last && distance > tiers[tier].maxDistance)
+    {
+        tier++;
+    }
+
+    // Outside the field of view counts as one tier less significant: dot(offset / distance, forward) < cos(fov / 2)
+    const auto dot = offset[0] * view.forward[0] + offset[1] * view.forward[1] + offset[2] * view.forward[2];
+    const auto halfAngleCosine = std::cos(view.fieldOfViewDegrees * 0.5f * 3.14159265f / 180.0f);
+    if (dot < halfAngleCosine * distance)
+    {
+        tier = std::min(tier + 1, last);
+    }
+
+    return tier;
+}
+
+void SignificanceManager::Tick(Object& object, SignificanceStats& stats)
+{
+    stats.ticked++;
+    stats.maxFramesSinceTick = std::max(stats.maxFramesSinceTick, object.framesSinceTick);
+
+    const auto seconds = object.pendingSeconds;
+    object.pendingSeconds = 0.0f;
+    object.framesSinceTick = 0;
+    object.tick(seconds);
+}
+
+SignificanceStats SignificanceManager::Update(const SignificanceView& view, float deltaSeconds, double budgetSeconds)
+{
+    Stopwatch stopwatch;
+    SignificanceStats stats;
+
+    for (auto& bucket : buckets)
+    {
+        bucket.clear();
+    }
+
+    // Slots go in ascending order, so every bucket is sorted
+    for (std::uint32_t index = 0; index < objects.size(); index++)
+    {
+        auto& object = objects[index];
+        if (!object.alive)
+        {
+            continue;
+        }
+
+        object.pendingSeconds += deltaSeconds;
+        object.framesSinceTick++;
+        object.tier = ComputeTier(view, object);
+        buckets[object.tier].push_back(index);
+        stats.objectsPerTier[object.tier]++;
+    }
+
+    for (auto index : buckets[0])
+    {
+        Tick(objects[index], stats);
+    }
+
+    Stopwatch budgetStopwatch;
+
+    for (std::size_t tier = 1; tier < tiers.size(); tier++)
+    {
+        const auto& bucket = buckets[tier];
+        const auto interval = tiers[tier].tickInterval;
+        if (bucket.empty())
+        {
+            continue;
+        }
+
+        // Continue the round-robin with the first object that didn't get its turn last time
+        const auto start = static_cast<std::size_t>(std::lower_bound(bucket.begin(), bucket.end(), cursors[tier]) - bucket.begin());
+        auto stopped = false;
+
+        for (std::size_t i = 0; i < bucket.size(); i++)
+        {
+            const auto index = bucket[(start + i) % bucket.size()];
+            auto& object = objects[index];
+            if (object.framesSinceTick < interval)
+            {
+                continue;
+            }
+
+            // Objects that already waited twice as long as they should tick no matter what, so a tight budget can't starve them
+            const auto overBudget = budgetSeconds > 0.0 && budgetStopwatch.ElapsedSeconds() >= budgetSeconds;
+            if (overBudget && object.framesSinceTick < interval * 2)
+            {
+                stats.deferred++;
+                stats.maxFramesSinceTick = std::max(stats.maxFramesSinceTick, object.framesSinceTick);
+                if (!stopped)
+                {
+                    cursors[tier] = index;
+                    stopped = true;
+                }
+                continue;
+            }
+
+            Tick(object, stats);
+        }
+    }
+
+    stats.seconds = stopwatch.ElapsedSeconds();
+    return stats;
+}
+
+SignificanceStats SignificanceManager::UpdateAll(float deltaSeconds)
+{
+    Stopwatch stopwatch;
+    SignificanceStats stats;
+
+    for (auto& object : objects)
+    {
+        if (!object.alive)
+        {
+            continue;
+        }
+
+        object.pendingSeconds += deltaSeconds;
+        object.framesSinceTick++;
+        stats.objectsPerTier[0]++;
+        Tick(object, stats);
+    }
+
+    stats.seconds = stopwatch.ElapsedSeconds();
+    return stats;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+/*
+ * SignificanceManager - ticking characters less often the less they matter
+ *
+ * ACppProjectCharacter moves, updates its camera boom and applies its rotation every single frame,
+ * whether it's right in front of the FollowCamera or a tiny dot a kilometer away behind it.
+ * With a handful of characters that's fine, with thousands the frame time grows with every one of them.
+ *
+ * The manager gives every object a significance from its distance to the view point and whether it's in
+ * front of the camera, and puts it into a tier:
+ *
+ *      tier 0  close and visible       every frame
+ *      tier 1                          every 2nd frame
+ *      tier 2                          every 4th frame
+ *      tier 3  far away or behind      every 8th frame
+ *
+ * Objects that skipped frames get the time they missed passed to their tick function, so they still move at the right speed.
+ *
+ * On top of that there is a time budget per frame. Tier 0 always ticks, the other tiers tick round-robin until the
+ * budget runs out. Whoever didn't get a turn is first in line next frame, so nobody waits forever.
+ *
+ *      SignificanceManager manager;
+ *      auto handle = manager.Register([&](float deltaSeconds) { character.Tick(deltaSeconds); });
+ *      manager.SetLocation(handle, x, y, z);
+ *
+ *      // Once per frame
+ *      manager.Update(cameraView, deltaSeconds, 0.004);
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct SignificanceView
+{
+	float location[3] = { 0.0f, 0.0f, 0.0f };
+
+	// Must be normalized
+	float forward[3] = { 1.0f, 0.0f, 0.0f };
+
+	// Horizontal field of view, 90 is the UCameraComponent default
+	float fieldOfViewDegrees = 90.0f;
+};
+
+struct SignificanceTier
+{
+	// Objects up to this distance (cm) belong to the tier, the last tier takes everything beyond
+	float maxDistance;
+
+	// Tick once every this many frames
+	int tickInterval;
+};
+
+struct SignificanceStats
+{
+	static constexpr std::size_t MaxTiers = 8;
+
+	std::array<std::size_t, MaxTiers> objectsPerTier{};
+	std::size_t ticked = 0;
+
+	// Objects that were due but didn't fit into the budget
+	std::size_t deferred = 0;
+
+	// The most frames any object has gone without ticking
+	int maxFramesSinceTick = 0;
+
+	double seconds = 0.0;
+};
+
+class SignificanceManager
+{
+public:
+	// The object's slot, and which use of that slot it is. Once the object is unregistered the handle stops
+	// working, instead of quietly pointing at whichever object gets the slot next.
+	struct Handle
+	{
+		std::uint32_t index = ~0u;
+		std::uint32_t generation = 0;
+	};
+
+	using TickFunction = std::function<void(float deltaSeconds)>;
+
+	SignificanceManager();
+
+	// Tiers sorted by maxDistance, at most SignificanceStats::MaxTiers of them
+	explicit SignificanceManager(std::vector<SignificanceTier> tiers);
+
+	Handle Register(TickFunction tick);
+
+	// Handles that are no longer registered are ignored, here and in SetLocation()
+	void Unregister(Handle handle);
+
+	// Can also be called from inside a tick function, the new location is used from the next Update() on
+	// Register() and Unregister() can't, they may move the tick function that is running
+	void SetLocation(Handle handle, float x, float y, float z);
+
+	// 0 for the most significant tier, valid after the first Update(). -1 if the handle is no longer registered.
+	int GetTier(Handle handle) const;
+
+	/*
+	 * Scores all objects and ticks the ones that are due
+	 * budgetSeconds limits how long the ticking may take, 0 means no limit. Tier 0 ignores the budget.
+	 */
+	SignificanceStats Update(const SignificanceView& view, float deltaSeconds, double budgetSeconds);
+
+	// Ticks every object every frame, what Update() does without any throttling
+	SignificanceStats UpdateAll(float deltaSeconds);
+
+	std::size_t Num() const { return objects.size() - freeSlots.size(); }
+
+private:
+	struct Object
+	{
+		TickFunction tick;
+		float location[3] = { 0.0f, 0.0f, 0.0f };
+		float pendingSeconds = 0.0f;
+		int framesSinceTick = 0;
+		int tier = 0;
+		bool alive = false;
+
+		// Goes up every time the object in this slot is unregistered
+		std::uint32_t generation = 0;
+	};
+
+	// nullptr if the handle is no longer registered
+	Object* Find(Handle handle);
+	const Object* Find(Handle handle) const;
+
+	int ComputeTier(const SignificanceView& view, const Object& object) const;
+	void Tick(Object& object, SignificanceStats& stats);
+
+	std::vector<SignificanceTier> tiers;
+	std::vector<Object> objects;
+	std::vector<std::uint32_t> freeSlots;
+
+	// Slots per tier, rebuilt every Update(), and where each tier's round-robin continues
+	std::vector<std::vector<std::uint32_t>> buckets;
+	std::vector<std::uint32_t> cursors;
+};
@@ -0,0 +1,128 @@
+#include "SmallString.h"
+#include <cstring>
+#include <new>
+#include <utility>
+
+SmallString::SmallString() : length(0), capacity(0)
+{
+    inlineBuffer[0] = '\0';
+}
+
+SmallString::SmallString(const char* text) : SmallString(std::string_view(text))
+{
+}
+
+SmallString::SmallString(std::string_view text) : length(static_cast<std::uint32_t>(text.size())), capacity(0)
+{
+    // The final size is known up front, so go straight to the right buffer
+    if (text.size() > InlineCapacity)
+    {
+        heapBuffer = new char[text.size() + 1];
+        capacity = length;
+    }
+
+    auto data = GetMutableData();
+    std::memcpy(data, text.data(), text.size());
+    data[length] = '\0';
+}
+
+SmallString::SmallString(const SmallString& other) : SmallString(other.ToStringView())
+{
+}
+
+SmallString::SmallString(SmallString&& other) noexcept : length(other.length), capacity(other.capacity)
+{
+    if (other.IsInline())
+    {
+        std::memcpy(inlineBuffer, other.inlineBuffer, other.length + 1);
+    }
+    else
+    {
+        // Steal the heap buffer and leave the other string empty
+        heapBuffer = other.heapBuffer;
+        other.capacity = 0;
+        other.length = 0;
+        other.inlineBuffer[0] = '\0';
+    }
+}
+
+SmallString& SmallString::operator=(const SmallString& other)
+{
+    if (this != &other)
+    {
+        length = 0;
+        Append(other.ToStringView());
+    }
+    return *this;
+}
+
+SmallString& SmallString::operator=(SmallString&& other) noexcept
+{
+    if (this != &other)
+    {
+        this->~SmallString();
+        new (this) SmallString(std::move(other));
+    }
+    return *this;
+}
+
+SmallString::~SmallString()
+{
+    if (!IsInline())
+    {
+        delete[] heapBuffer;
+    }
+}
+
+void SmallString::Reserve(std::size_t newCapacity)
+{
+    const auto currentCapacity = IsInline() ? InlineCapacity : capacity;
+    if (newCapacity <= currentCapacity)
+    {
+        return;
+    }
+
+    // Grow by at least half, so appending in a loop doesn't reallocate every time
+    newCapacity = newCapacity > currentCapacity + currentCapacity / 2 ? newCapacity : currentCapacity + currentCapacity / 2;
+
+    auto newBuffer = new char[newCapacity + 1];
+    std::memcpy(newBuffer, GetData(), length + 1);
+
+    if (!IsInline())
+    {
+        delete[] heapBuffer;
+    }
+
+    heapBuffer = newBuffer;
+    capacity = static_cast<std::uint32_t>(newCapacity);
+}
+
+void SmallString::Append(std::string_view text)
+{
+    const auto newLength = length + text.size();
+    const auto currentCapacity = IsInline() ? InlineCapacity : capacity;
+
+    if (newLength > currentCapacity)
+    {
+        // 'text' could point into our own buffer, which Reserve() is about to free
+        if (text.data() >= begin() && text.data() <= end())
+        {
+            const SmallString copy(text);
+            Append(copy.ToStringView());
+            return;
+        }
+
+        Reserve(newLength);
+    }
+
+    auto data = GetMutableData();
+    std::memmove(data + length, text.data(), text.size());
+    length = static_cast<std::uint32_t>(newLength);
+    data[length] = '\0';
+}
+
+SmallString& SmallString::operator+=(std::string_view text)
+{
+    Append(text);
+    return *this;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+ * SmallString - a string that keeps short text inside itself
+ *
+ * std::string can usually only hold about 15 characters before it has to allocate memory on the heap.
+ * SmallString is 64 bytes big (exactly one cache line) and holds up to 55 characters without allocating,
+ * which covers most names and many asset paths.
+ *
+ * Longer text is moved to the heap, just like std::string does.
+ *
+ * It's about saving allocations, not time: copying and comparing short text is a little slower than with std::string,
+ * which is half the size (see "bench strings").
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+class SmallString
+{
+public:
+	static constexpr std::size_t InlineCapacity = 55;
+
+	SmallString();
+	SmallString(const char* text);
+	SmallString(std::string_view text);
+
+	SmallString(const SmallString& other);
+	SmallString(SmallString&& other) noexcept;
+	SmallString& operator=(const SmallString& other);
+	SmallString& operator=(SmallString&& other) noexcept;
+
+	~SmallString();
+
+	std::size_t Len() const { return length; }
+	bool IsEmpty() const { return length == 0; }
+
+	// True while the text still fits into the string itself
+	bool IsInline() const { return capacity == 0; }
+
+	// Always null terminated
+	const char* GetData() const { return IsInline() ? inlineBuffer : heapBuffer; }
+
+	std::string_view ToStringView() const { return std::string_view(GetData(), length); }
+	operator std::string_view() const { return ToStringView(); }
+
+	void Reserve(std::size_t newCapacity);
+	void Append(std::string_view text);
+	SmallString& operator+=(std::string_view text);
+
+	const char* begin() const { return GetData(); }
+	const char* end() const { return GetData() + length; }
+
+	// Different lengths are told apart without looking at the text
+	bool operator==(const SmallString& other) const { return length == other.length && std::memcmp(GetData(), other.GetData(), length) == 0; }
+	bool operator!=(const SmallString& other) const { return !(*this == other); }
+	bool operator<(const SmallString& other) const { return ToStringView() < other.ToStringView(); }
+
+private:
+	char* GetMutableData() { return IsInline() ? inlineBuffer : heapBuffer; }
+
+	// Either the text itself, or a pointer to the text on the heap
+	union
+	{
+		char inlineBuffer[InlineCapacity + 1];
+		char* heapBuffer;
+	};
+
+	std::uint32_t length;
+
+	// 0 while inline, otherwise the number of characters the heap buffer can hold
+	std::uint32_t capacity;
+};
+
+template <>
+struct std::hash<SmallString>
+{
+	std::size_t operator()(const SmallString& text) const noexcept { return std::hash<std::string_view>()(text.ToStringView()); }
+};
@@ -0,0 +1,360 @@
+#include "SnapshotReplication.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Positions are whole centimeters, 22 bits covers -20 km to +20 km
+    constexpr int PositionBits = 22;
+    constexpr std::int32_t PositionLimit = (1 << (PositionBits - 1)) - 1;
+
+    // Velocities are whole centimeters per second, 14 bits covers -81 m/s to +81 m/s
+    constexpr int VelocityBits = 14;
+    constexpr std::int32_t VelocityLimit = (1 << (VelocityBits - 1)) - 1;
+
+    constexpr int RotationBits = 16;
+
+    // Changes this small are sent with fewer bits
+    constexpr int SmallPositionBits = 8;
+    constexpr int SmallVelocityBits = 6;
+
+    constexpr int SequenceBits = 16;
+    constexpr int CountBits = 16;
+    static_assert(SnapshotSender::MaxCharacters < (1u << CountBits), "The character count must fit into CountBits");
+    constexpr int IdBits = 32;
+
+    std::int32_t QuantizeLinear(float value, std::int32_t limit)
+    {
+        // Clamp before rounding, rounding a value that doesn't fit into an integer is undefined
+        const auto clamped = std::clamp(value, static_cast<float>(-limit), static_cast<float>(limit));
+        return static_cast<std::int32_t>(std::lround(clamped));
+    }
+
+    std::uint16_t QuantizeAngle(float degrees)
+    {
+        // 65536 steps per full turn, the mask wraps negative angles around
+        const auto wrapped = std::remainder(degrees, 360.0f);
+        return static_cast<std::uint16_t>(std::lround(wrapped * (65536.0f / 360.0f)) & 0xFFFF);
+    }
+
+    float DequantizeAngle(std::uint16_t quantized)
+    {
+        const auto degrees = quantized * (360.0f / 65536.0f);
+        return degrees > 180.0f ? degrees - 360.0f : degrees;
+    }
+
+    bool FitsSigned(std::int64_t value, int bits)
+    {
+        const auto limit = std::int64_t(1) << (bits - 1);
+        return value >= -limit && value < limit;
+    }
+
+    void WriteLinear(BitWriter& writer, std::int32_t base, std::int32_t value, int smallBits, int fullBits)
+    {
+        const auto delta = static_cast<std::int64_t>(value) - base;
+        if (FitsSigned(delta, smallBits))
+        {
+            writer.WriteBool(true);
+            writer.WriteSigned(static_cast<std::int32_t>(delta), smallBits);
+        }
+        else
+        {
+            writer.WriteBool(false);
+            writer.WriteSigned(value, fullBits);
+        }
+    }
+
+    std::int32_t ReadLinear(BitReader& reader, std::int32_t base, int smallBits, int fullBits)
+    {
+        if (reader.ReadBool())
+        {
+            return base + reader.ReadSigned(smallBits);
+        }
+        return reader.ReadSigned(fullBits);
+    }
+
+    /*
+     * Per character: one 'changed' bit per group of fields, followed by the new values only for groups that changed
+     * A character without a baseline is encoded against an all-zero character
+     */
+    void WriteCharacter(BitWriter& writer, const QuantizedCharacter& base, const QuantizedCharacter& current)
+    {
+        const auto locationChanged = !std::equal(std::begin(base.location), std::end(base.location), std::begin(current.location));
+        writer.WriteBool(locationChanged);
+        if (locationChanged)
+        {
+            for (auto axis = 0; axis < 3; axis++)
+            {
+                WriteLinear(writer, base.location[axis], current.location[axis], SmallPositionBits, PositionBits);
+            }
+        }
+
+        writer.WriteBool(base.yaw != current.yaw);
+        if (base.yaw != current.yaw)
+        {
+            writer.WriteBits(current.yaw, RotationBits);
+        }
+
+        writer.WriteBool(base.pitch != current.pitch);
+        if (base.pitch != current.pitch)
+        {
+            writer.WriteBits(current.pitch, RotationBits);
+        }
+
+        const auto velocityChanged = !std::equal(std::begin(base.velocity), std::end(base.velocity), std::begin(current.velocity));
+        writer.WriteBool(velocityChanged);
+        if (velocityChanged)
+        {
+            for (auto axis = 0; axis < 3; axis++)
+            {
+                WriteLinear(writer, base.velocity[axis], current.velocity[axis], SmallVelocityBits, VelocityBits);
+            }
+        }
+
+        writer.WriteBool(current.isJumping);
+    }
+
+    QuantizedCharacter ReadCharacter(BitReader& reader, const QuantizedCharacter& base)
+    {
+        auto current = base;
+
+        if (reader.ReadBool())
+        {
+            for (auto axis = 0; axis < 3; axis++)
+            {
+                current.location[axis] = ReadLinear(reader, base.location[axis], SmallPositionBits, PositionBits);
+            }
+        }
+
+        if (reader.ReadBool())
+        {
+            current.yaw = static_cast<std::uint16_t>(reader.ReadBits(RotationBits));
+        }
+
+        if (reader.ReadBool())
+        {
+            current.pitch = static_cast<std::uint16_t>(reader.ReadBits(RotationBits));
+        }
+
+        if (reader.ReadBool())
+        {
+            for (auto axis = 0; axis < 3; axis++)
+            {
+                current.velocity[axis] = static_cast<std::int16_t>(ReadLinear(reader, base.velocity[axis], SmallVelocityBits, VelocityBits));
+            }
+        }
+
+        current.isJumping = reader.ReadBool();
+        return current;
+    }
+}
+
+bool QuantizedCharacter::operator==(const QuantizedCharacter& other) const
+{
+    return std::equal(std::begin(location), std::end(location), std::begin(other.location))
+        && yaw == other.yaw && pitch == other.pitch
+        && std::equal(std::begin(velocity), std::end(velocity), std::begin(other.velocity))
+        && isJumping == other.isJumping;
+}
+
+QuantizedCharacter Quantize(const CharacterState& state)
+{
+    QuantizedCharacter quantized;
+    quantized.location[0] = QuantizeLinear(state.locationX, PositionLimit);
+    quantized.location[1] = QuantizeLinear(state.locationY, PositionLimit);
+    quantized.location[2] = QuantizeLinear(state.locationZ, PositionLimit);
+    quantized.yaw = QuantizeAngle(state.yaw);
+    quantized.pitch = QuantizeAngle(state.pitch);
+    quantized.velocity[0] = static_cast<std::int16_t>(QuantizeLinear(state.velocityX, VelocityLimit));
+    quantized.velocity[1] = static_cast<std::int16_t>(QuantizeLinear(state.velocityY, VelocityLimit));
+    quantized.velocity[2] = static_cast<std::int16_t>(QuantizeLinear(state.velocityZ, VelocityLimit));
+    quantized.isJumping = state.isJumping;
+    return quantized;
+}
+
+CharacterState Dequantize(const QuantizedCharacter& quantized)
+{
+    CharacterState state;
+    state.locationX = static_cast<float>(quantized.location[0]);
+    state.locationY = static_cast<float>(quantized.location[1]);
+    state.locationZ = static_cast<float>(quantized.location[2]);
+    state.yaw = DequantizeAngle(quantized.yaw);
+    state.pitch = DequantizeAngle(quantized.pitch);
+    state.velocityX = quantized.velocity[0];
+    state.velocityY = quantized.velocity[1];
+    state.velocityZ = quantized.velocity[2];
+    state.isJumping = quantized.isJumping;
+    return state;
+}
+
+bool IsSequenceNewer(std::uint16_t sequence, std::uint16_t than)
+{
+    return static_cast<std::int16_t>(static_cast<std::uint16_t>(sequence - than)) > 0;
+}
+
+/*
+ * SnapshotSender
+ */
+
+bool SnapshotSender::Encode(const std::vector<ReplicatedCharacter>& characters, BitWriter& writer)
+{
+    // A bigger count would be cut off to 16 bits, and the receiver would read the wrong number of characters
+    if (characters.size() > MaxCharacters)
+    {
+        return false;
+    }
+
+    const auto sequence = nextSequence++;
+
+    const Snapshot* baseline = nullptr;
+    if (hasAck)
+    {
+        const auto& candidate = history[ackedSequence % HistorySize];
+        if (candidate.valid && candidate.sequence == ackedSequence)
+        {
+            baseline = &candidate;
+        }
+    }
+
+    writer.WriteBits(sequence, SequenceBits);
+    writer.WriteBool(baseline != nullptr);
+    if (baseline != nullptr)
+    {
+        writer.WriteBits(baseline->sequence, SequenceBits);
+    }
+    writer.WriteBits(static_cast<std::uint32_t>(characters.size()), CountBits);
+
+    // Both lists are sorted by id, so the baseline of each character is found by walking them side by side
+    const QuantizedCharacter zero;
+    std::size_t baseIndex = 0;
+    std::uint32_t previousId = ~0u;
+
+    for (const auto& character : characters)
+    {
+        // Consecutive ids cost a single bit
+        const auto consecutive = character.id == previousId + 1;
+        writer.WriteBool(consecutive);
+        if (!consecutive)
+        {
+            writer.WriteBits(character.id, IdBits);
+        }
+        previousId = character.id;
+
+        const QuantizedCharacter* base = &zero;
+        if (baseline != nullptr)
+        {
+            while (baseIndex < baseline->characters.size() && baseline->characters[baseIndex].id < character.id)
+            {
+                baseIndex++;
+            }
+            if (baseIndex < baseline->characters.size() && baseline->characters[baseIndex].id == character.id)
+            {
+                base = &baseline->characters[baseIndex].state;
+            }
+        }
+
+        WriteCharacter(writer, *base, character.state);
+    }
+
+    auto& slot = history[sequence % HistorySize];
+    slot.sequence = sequence;
+    slot.valid = true;
+    slot.characters = characters;
+    return true;
+}
+
+void SnapshotSender::Acknowledge(std::uint16_t sequence)
+{
+    // Ignore acknowledgements that arrive out of order or for snapshots we never sent
+    if (!IsSequenceNewer(nextSequence, sequence))
+    {
+        return;
+    }
+
+    if (!hasAck || IsSequenceNewer(sequence, ackedSequence))
+    {
+        ackedSequence = sequence;
+        hasAck = true;
+    }
+}
+
+/*
+ * SnapshotReceiver
+ */
+
+bool SnapshotReceiver::Decode(const std::uint8_t* data, std::size_t size)
+{
+    BitReader reader(data, size);
+
+    const auto sequence = static_cast<std::uint16_t>(reader.ReadBits(SequenceBits));
+    if (hasLatest && !IsSequenceNewer(sequence, latestSequence))
+    {
+        return false;
+    }
+
+    const Snapshot* baseline = nullptr;
+    if (reader.ReadBool())
+    {
+        const auto baselineSequence = static_cast<std::uint16_t>(reader.ReadBits(SequenceBits));
+        const auto& candidate = history[baselineSequence % HistorySize];
+        if (!candidate.valid || candidate.sequence != baselineSequence)
+        {
+            return false;
+        }
+        baseline = &candidate;
+    }
+
+    const auto count = reader.ReadBits(CountBits);
+    if (reader.IsOverflowed())
+    {
+        return false;
+    }
+
+    std::vector<ReplicatedCharacter> characters;
+    characters.reserve(count);
+
+    const QuantizedCharacter zero;
+    std::size_t baseIndex = 0;
+    std::uint32_t previousId = ~0u;
+
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        const auto id = reader.ReadBool() ? previousId + 1 : reader.ReadBits(IdBits);
+        previousId = id;
+
+        const QuantizedCharacter* base = &zero;
+        if (baseline != nullptr)
+        {
+            while (baseIndex < baseline->characters.size() && baseline->characters[baseIndex].id < id)
+            {
+                baseIndex++;
+            }
+            if (baseIndex < baseline->characters.size() && baseline->characters[baseIndex].id == id)
+            {
+                base = &baseline->characters[baseIndex].state;
+            }
+        }
+
+        characters.push_back({ id, ReadCharacter(reader, *base) });
+
+        if (reader.IsOverflowed())
+        {
+            return false;
+        }
+    }
+
+    auto& slot = history[sequence % HistorySize];
+    slot.sequence = sequence;
+    slot.valid = true;
+    slot.characters = std::move(characters);
+
+    latestSequence = sequence;
+    hasLatest = true;
+    return true;
+}
+
+const std::vector<ReplicatedCharacter>& SnapshotReceiver::GetCharacters() const
+{
+    static const std::vector<ReplicatedCharacter> none;
+    return hasLatest ? history[latestSequence % HistorySize].characters : none;
+}
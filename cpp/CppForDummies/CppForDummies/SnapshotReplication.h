@@ -0,0 +1,128 @@
+#pragma once
+
+/*
+ * Snapshot replication - sending character movement to clients with as few bits as possible
+ *
+ * ACppProjectCharacter's movement state is a location, the control rotation (yaw from TurnAtRate, pitch from LookUpAtRate),
+ * a velocity and whether it's jumping. Sent as plain floats that's 37 bytes per character per tick.
+ *
+ * Two tricks make it much smaller:
+ *
+ * Quantization - nobody can see the difference between 1.0 cm and 1.003 cm, so values are rounded to a fixed
+ *      precision and stored as small integers (positions to 1 cm in 22 bits, rotations in 16 bits, velocity to 1 cm/s in 14 bits)
+ *
+ * Delta encoding - the server remembers what every client has confirmed receiving (acknowledged) and only
+ *      sends what changed since then. A character standing still costs a couple of bits.
+ *
+ * Every client gets its own SnapshotSender on the server and has a SnapshotReceiver on its side.
+ * The receiver tells the server which snapshot it got via Acknowledge(), over whatever channel the game uses.
+ * Lost packets are fine, the server just keeps encoding against the last snapshot the client confirmed.
+ */
+
+#include "BitStream.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct CharacterState
+{
+	float locationX = 0.0f;
+	float locationY = 0.0f;
+	float locationZ = 0.0f;
+
+	// Degrees
+	float yaw = 0.0f;
+	float pitch = 0.0f;
+
+	float velocityX = 0.0f;
+	float velocityY = 0.0f;
+	float velocityZ = 0.0f;
+
+	bool isJumping = false;
+};
+
+struct QuantizedCharacter
+{
+	std::int32_t location[3] = { 0, 0, 0 };
+	std::uint16_t yaw = 0;
+	std::uint16_t pitch = 0;
+	std::int16_t velocity[3] = { 0, 0, 0 };
+	bool isJumping = false;
+
+	bool operator==(const QuantizedCharacter& other) const;
+	bool operator!=(const QuantizedCharacter& other) const { return !(*this == other); }
+};
+
+QuantizedCharacter Quantize(const CharacterState& state);
+CharacterState Dequantize(const QuantizedCharacter& quantized);
+
+struct ReplicatedCharacter
+{
+	std::uint32_t id;
+	QuantizedCharacter state;
+};
+
+// Snapshot sequence numbers are 16 bits and wrap around, this compares them correctly across the wrap
+bool IsSequenceNewer(std::uint16_t sequence, std::uint16_t than);
+
+class SnapshotSender
+{
+public:
+	// How many sent snapshots are remembered. Acknowledgements for anything older are ignored.
+	static constexpr std::size_t HistorySize = 64;
+
+	// The character count is sent in 16 bits
+	static constexpr std::size_t MaxCharacters = 65535;
+
+	/*
+	 * Writes a snapshot of all characters, delta encoded against the newest snapshot the client acknowledged
+	 * 'characters' must be sorted by id. Returns false, and writes nothing, if there are more than MaxCharacters.
+	 */
+	bool Encode(const std::vector<ReplicatedCharacter>& characters, BitWriter& writer);
+
+	void Acknowledge(std::uint16_t sequence);
+
+private:
+	struct Snapshot
+	{
+		std::uint16_t sequence = 0;
+		bool valid = false;
+		std::vector<ReplicatedCharacter> characters;
+	};
+
+	std::array<Snapshot, HistorySize> history;
+	std::uint16_t nextSequence = 0;
+	std::uint16_t ackedSequence = 0;
+	bool hasAck = false;
+};
+
+class SnapshotReceiver
+{
+public:
+	static constexpr std::size_t HistorySize = SnapshotSender::HistorySize;
+
+	/*
+	 * Decodes a packet written by SnapshotSender::Encode
+	 * Returns false if the packet is broken, out of date, or its baseline snapshot is no longer known
+	 */
+	bool Decode(const std::uint8_t* data, std::size_t size);
+
+	// The sequence to acknowledge to the server, valid once Decode() succeeded at least once
+	std::uint16_t GetLatestSequence() const { return latestSequence; }
+
+	// The characters of the newest snapshot, sorted by id
+	const std::vector<ReplicatedCharacter>& GetCharacters() const;
+
+private:
+	struct Snapshot
+	{
+		std::uint16_t sequence = 0;
+		bool valid = false;
+		std::vector<ReplicatedCharacter> characters;
+	};
+
+	std::array<Snapshot, HistorySize> history;
+	std::uint16_t latestSequence = 0;
+	bool hasLatest = false;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+
+/*
+ * A tiny helper for timing code in the benchmarks
+ *
+ * The clock starts when the stopwatch is created and Restart() sets it back to zero
+ * steady_clock is used since it never jumps backwards, unlike the wall clock
+ */
+
+class Stopwatch
+{
+public:
+	Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+	void Restart() { start = std::chrono::steady_clock::now(); }
+
+	double ElapsedSeconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	double ElapsedNanoseconds() const
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point start;
+};